@@ -0,0 +1,348 @@
+#pragma once
+
+#include "renderer.hpp"
+#include "surface.hpp"
+
+#include <SDL_pixels.h>
+#include <SDL_rwops.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sdl2
+{
+	enum class CaptureFormat
+	{
+		BMP,
+		PNG, // needs SDL2_ENABLE_IMG
+		JPG, // needs SDL2_ENABLE_IMG
+		RAW  // bare pixels appended to the file, e.g. for ffmpeg -f rawvideo
+	};
+
+	// PNG when SDL_image is built in, BMP otherwise.
+#ifdef SDL2_ENABLE_IMG
+	inline constexpr CaptureFormat DEFAULT_CAPTURE_FORMAT = CaptureFormat::PNG;
+#else
+	inline constexpr CaptureFormat DEFAULT_CAPTURE_FORMAT = CaptureFormat::BMP;
+#endif
+
+	enum class CaptureDropPolicy
+	{
+		DROP_NEWEST, // a full queue rejects the new frame
+		DROP_OLDEST  // a full queue discards its oldest frame
+	};
+
+	struct CaptureStats
+	{
+		std::uint64_t submitted = 0;
+		std::uint64_t written = 0;
+		std::uint64_t dropped = 0;
+		std::uint64_t failed = 0;
+	};
+
+	// Screenshots and recordings without stalling the frame.
+	// capture() only reads the pixels back into a recycled buffer; encoding and file IO happen on a
+	// worker thread. The queue holds at most queueCapacity frames and applies the drop policy once
+	// full, so a slow disk costs frames instead of frame time. Call capture() or record() after
+	// drawing and before Renderer::present(), from the thread that owns the renderer.
+	class FrameCapture
+	{
+	public:
+		[[nodiscard]] explicit FrameCapture(std::size_t queueCapacity = 8, CaptureDropPolicy policy = CaptureDropPolicy::DROP_OLDEST, std::uint32_t pixelFormat = SDL_PIXELFORMAT_ARGB8888)
+			: m_QueueCapacity(std::max<std::size_t>(queueCapacity, 1))
+			, m_Policy(policy)
+			, m_PixelFormat(pixelFormat)
+		{
+			m_Worker = std::thread{ [this] { work(); } };
+		}
+
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		// Writes every queued frame before returning.
+		~FrameCapture()noexcept
+		{
+			{
+				std::lock_guard lock{ m_Mutex };
+				m_IsStopping = true;
+			}
+			m_HasWork.notify_all();
+			m_Worker.join();
+		}
+
+		bool capture(sdl2::Renderer& renderer, std::string file, CaptureFormat format = DEFAULT_CAPTURE_FORMAT, int quality = 90)
+		{
+			const std::optional<SDL_Point> size = renderer.getOutputSize();
+			if (!size)
+			{
+				return false;
+			}
+			return capture(renderer, SDL_Rect{ 0, 0, size->x, size->y }, std::move(file), format, quality);
+		}
+
+		bool capture(sdl2::Renderer& renderer, const SDL_Rect& rect, std::string file, CaptureFormat format = DEFAULT_CAPTURE_FORMAT, int quality = 90)
+		{
+			if (rect.w <= 0 || rect.h <= 0)
+			{
+				return false;
+			}
+			Job job;
+			job.w = rect.w;
+			job.h = rect.h;
+			job.pitch = rect.w * static_cast<int>(SDL_BYTESPERPIXEL(m_PixelFormat));
+			job.pixels = acquireBuffer(static_cast<std::size_t>(job.pitch) * static_cast<std::size_t>(job.h));
+			job.file = std::move(file);
+			job.format = format;
+			job.quality = quality;
+			if (!renderer.readPixels(rect, m_PixelFormat, job.pixels.data(), job.pitch))
+			{
+				releaseBuffer(std::move(job.pixels));
+				m_Failed.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			return submit(std::move(job));
+		}
+
+		// Continuous capture at fps frames per second for QA recordings. Frames are named
+		// prefix_000000.ext, or all go to prefix.raw for CaptureFormat::RAW.
+		void startRecording(std::string prefix, double fps = 30.0, CaptureFormat format = CaptureFormat::RAW, int quality = 90)
+		{
+			m_RecordPrefix = std::move(prefix);
+			m_RecordFormat = format;
+			m_RecordQuality = quality;
+			m_RecordInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(fps, 0.001)));
+			m_NextRecordTime = Clock::now();
+			m_RecordedFrames = 0;
+			m_IsRecording = true;
+		}
+
+		void stopRecording()noexcept { m_IsRecording = false; }
+
+		// Call once per frame; captures when the next recording frame is due. Returns whether it did.
+		bool record(sdl2::Renderer& renderer)
+		{
+			if (!m_IsRecording)
+			{
+				return false;
+			}
+			const Clock::time_point now = Clock::now();
+			if (now < m_NextRecordTime)
+			{
+				return false;
+			}
+			// A hitch skips the missed frames instead of capturing a burst.
+			m_NextRecordTime = std::max(m_NextRecordTime + m_RecordInterval, now);
+			std::string file = m_RecordPrefix;
+			if (m_RecordFormat == CaptureFormat::RAW)
+			{
+				file += ".raw";
+			}
+			else
+			{
+				char index[16];
+				std::snprintf(index, sizeof(index), "_%06u", m_RecordedFrames);
+				file += index;
+				file += getExtension(m_RecordFormat);
+			}
+			++m_RecordedFrames;
+			return capture(renderer, std::move(file), m_RecordFormat, m_RecordQuality);
+		}
+
+		// Blocks until every queued frame is written.
+		void flush()
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_IsIdle.wait(lock, [this] { return m_Queue.empty() && !m_IsWriting; });
+		}
+
+		[[nodiscard]] bool isRecording()const noexcept { return m_IsRecording; }
+
+		[[nodiscard]] std::uint32_t getPixelFormat()const noexcept { return m_PixelFormat; }
+
+		[[nodiscard]] std::size_t getQueuedCount()const
+		{
+			std::lock_guard lock{ m_Mutex };
+			return m_Queue.size();
+		}
+
+		[[nodiscard]] CaptureStats getStats()const noexcept
+		{
+			return CaptureStats{ m_Submitted.load(std::memory_order_relaxed), m_Written.load(std::memory_order_relaxed), m_Dropped.load(std::memory_order_relaxed), m_Failed.load(std::memory_order_relaxed) };
+		}
+
+		[[nodiscard]] static const char* getExtension(CaptureFormat format)noexcept
+		{
+			switch (format)
+			{
+			case CaptureFormat::BMP: return ".bmp";
+			case CaptureFormat::PNG: return ".png";
+			case CaptureFormat::JPG: return ".jpg";
+			case CaptureFormat::RAW: return ".raw";
+			}
+			return "";
+		}
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct Job
+		{
+			std::vector<std::uint8_t> pixels;
+			int w = 0;
+			int h = 0;
+			int pitch = 0;
+			std::string file;
+			CaptureFormat format = DEFAULT_CAPTURE_FORMAT;
+			int quality = 90;
+		};
+
+		[[nodiscard]] std::vector<std::uint8_t> acquireBuffer(std::size_t bytes)
+		{
+			std::vector<std::uint8_t> buffer;
+			{
+				std::lock_guard lock{ m_Mutex };
+				if (!m_FreeBuffers.empty())
+				{
+					buffer = std::move(m_FreeBuffers.back());
+					m_FreeBuffers.pop_back();
+				}
+			}
+			buffer.resize(bytes);
+			return buffer;
+		}
+
+		void releaseBuffer(std::vector<std::uint8_t> buffer)
+		{
+			std::lock_guard lock{ m_Mutex };
+			recycle(buffer);
+		}
+
+		// Holds on to at most queueCapacity + 2 spare buffers; the caller locks m_Mutex.
+		void recycle(std::vector<std::uint8_t>& buffer)
+		{
+			if (!buffer.empty() && m_FreeBuffers.size() < m_QueueCapacity + 2)
+			{
+				m_FreeBuffers.push_back(std::move(buffer));
+			}
+		}
+
+		bool submit(Job job)
+		{
+			m_Submitted.fetch_add(1, std::memory_order_relaxed);
+			{
+				std::lock_guard lock{ m_Mutex };
+				if (m_Queue.size() >= m_QueueCapacity)
+				{
+					m_Dropped.fetch_add(1, std::memory_order_relaxed);
+					if (m_Policy == CaptureDropPolicy::DROP_NEWEST)
+					{
+						recycle(job.pixels);
+						return false;
+					}
+					recycle(m_Queue.front().pixels);
+					m_Queue.pop_front();
+				}
+				m_Queue.push_back(std::move(job));
+			}
+			m_HasWork.notify_one();
+			return true;
+		}
+
+		[[nodiscard]] bool write(Job& job)const
+		{
+			if (job.format == CaptureFormat::RAW)
+			{
+				SDL_RWops* file = SDL_RWFromFile(job.file.c_str(), "ab");
+				if (file == nullptr)
+				{
+					return false;
+				}
+				const bool isWritten = SDL_RWwrite(file, job.pixels.data(), job.pixels.size(), 1) == 1;
+				return SDL_RWclose(file) == 0 && isWritten;
+			}
+			sdl2::Surface surface{ job.pixels.data(), job.w, job.h, static_cast<int>(SDL_BITSPERPIXEL(m_PixelFormat)), job.pitch, static_cast<int>(m_PixelFormat) };
+			if (!surface.isValid())
+			{
+				return false;
+			}
+			switch (job.format)
+			{
+			case CaptureFormat::BMP: return surface.saveToFile(job.file);
+#ifdef SDL2_ENABLE_IMG
+			case CaptureFormat::PNG: return surface.savePNG(job.file);
+			case CaptureFormat::JPG: return surface.saveJPG(job.file, job.quality);
+#endif
+			default: return false;
+			}
+		}
+
+		void work()
+		{
+			Job job;
+			for (;;)
+			{
+				{
+					std::unique_lock lock{ m_Mutex };
+					recycle(job.pixels);
+					m_IsWriting = false;
+					if (m_Queue.empty())
+					{
+						m_IsIdle.notify_all();
+					}
+					m_HasWork.wait(lock, [this] { return m_IsStopping || !m_Queue.empty(); });
+					if (m_Queue.empty())
+					{
+						return;
+					}
+					job = std::move(m_Queue.front());
+					m_Queue.pop_front();
+					m_IsWriting = true;
+				}
+				if (write(job))
+				{
+					m_Written.fetch_add(1, std::memory_order_relaxed);
+				}
+				else
+				{
+					m_Failed.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		std::size_t m_QueueCapacity;
+		CaptureDropPolicy m_Policy;
+		std::uint32_t m_PixelFormat;
+
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_HasWork;
+		std::condition_variable m_IsIdle;
+		std::deque<Job> m_Queue;
+		std::vector<std::vector<std::uint8_t>> m_FreeBuffers;
+		bool m_IsStopping = false;
+		bool m_IsWriting = false;
+
+		std::atomic<std::uint64_t> m_Submitted{ 0 };
+		std::atomic<std::uint64_t> m_Written{ 0 };
+		std::atomic<std::uint64_t> m_Dropped{ 0 };
+		std::atomic<std::uint64_t> m_Failed{ 0 };
+
+		std::string m_RecordPrefix;
+		CaptureFormat m_RecordFormat = CaptureFormat::RAW;
+		int m_RecordQuality = 90;
+		Clock::duration m_RecordInterval{ 0 };
+		Clock::time_point m_NextRecordTime;
+		unsigned m_RecordedFrames = 0;
+		bool m_IsRecording = false;
+
+		std::thread m_Worker;
+	};
+}
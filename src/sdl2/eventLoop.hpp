@@ -0,0 +1,293 @@
+#pragma once
+
+#include "events.hpp"
+#include "timerWheel.hpp"
+#include "windowManager.hpp"
+
+#include <SDL_events.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace sdl2
+{
+	// Reactive main loop for tools: sleeps in SDL_WaitEventTimeout until an event arrives, a timer
+	// fires, a window is due for its next frame or invalidate() is called, then redraws only the
+	// windows that need it. Idle tools use no CPU. invalidate() may be called from any thread;
+	// repeated calls before the loop wakes up result in one wake-up event and one redraw.
+	// Timers run on a TimerWheel with millisecond ticks that the loop advances every iteration.
+	class EventLoop
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+		using TimerId = TimerHandle;
+		using OnTimer = std::function<void()>;
+
+		[[nodiscard]] explicit EventLoop(WindowManager& windows)
+			: m_Windows(windows)
+		{
+			const std::uint32_t type = sdl2::events::registerEvents(1);
+			m_WakeEvent = type != static_cast<std::uint32_t>(-1) ? type : static_cast<std::uint32_t>(SDL_USEREVENT);
+		}
+
+		EventLoop(const EventLoop&) = delete;
+		EventLoop& operator=(const EventLoop&) = delete;
+
+		// Marks a window, or every window for id 0, for redraw and wakes the loop. Thread-safe.
+		void invalidate(std::uint32_t windowId = 0)
+		{
+			{
+				std::lock_guard lock{ m_InvalidMutex };
+				m_InvalidWindows.push_back(windowId);
+			}
+			wake();
+		}
+
+		// Makes run() return after the current iteration. Thread-safe.
+		void quit(int code = 0)
+		{
+			m_ExitCode.store(code, std::memory_order_relaxed);
+			m_IsRunning.store(false, std::memory_order_release);
+			wake();
+		}
+
+		// Calls onTimer after delay, then every interval if it is not zero. Main thread only.
+		TimerId addTimer(std::chrono::milliseconds delay, OnTimer onTimer, std::chrono::milliseconds interval = std::chrono::milliseconds{ 0 })
+		{
+			std::uint32_t index = 0;
+			if (m_FreeTimer != NONE)
+			{
+				index = m_FreeTimer;
+				m_FreeTimer = m_Timers[index].nextFree;
+			}
+			else
+			{
+				index = static_cast<std::uint32_t>(m_Timers.size());
+				m_Timers.emplace_back();
+			}
+			Timer& timer = m_Timers[index];
+			timer.loop = this;
+			timer.onTimer = std::move(onTimer);
+			timer.index = index;
+			timer.isRepeating = interval.count() > 0;
+			timer.handle = m_Wheel.add(delay, &EventLoop::onWheelTimer, &timer, interval);
+			if (m_TimerByNode.size() <= timer.handle.index)
+			{
+				m_TimerByNode.resize(timer.handle.index + 1, NONE);
+			}
+			m_TimerByNode[timer.handle.index] = index;
+			return timer.handle;
+		}
+
+		// Only cancels timers made by addTimer(); plain wheel timers share the handle type but
+		// are cancelled through getTimerWheel().
+		bool cancelTimer(TimerId id)
+		{
+			const std::uint32_t index = id.index < m_TimerByNode.size() ? m_TimerByNode[id.index] : NONE;
+			if (index == NONE || m_Timers[index].handle.index != id.index || m_Timers[index].handle.generation != id.generation
+				|| !m_Wheel.cancel(id))
+			{
+				return false;
+			}
+			// A timer cancelled from inside its own callback is released once the callback returns.
+			if (index != m_FiringTimer)
+			{
+				releaseTimer(index);
+			}
+			return true;
+		}
+
+		// The wheel behind addTimer(), for callers that prefer plain function pointer timers;
+		// they share its clock and its wake-ups.
+		[[nodiscard]] TimerWheel& getTimerWheel()noexcept { return m_Wheel; }
+
+		// Runs until quit(), SDL_QUIT or the last window closes; returns the exit code.
+		int run()
+		{
+			m_IsRunning.store(true, std::memory_order_relaxed);
+			while (m_IsRunning.load(std::memory_order_acquire))
+			{
+				runOnce();
+				if (m_Windows.isEmpty())
+				{
+					break;
+				}
+			}
+			return m_ExitCode.load(std::memory_order_relaxed);
+		}
+
+		// One iteration: waits at most maxWait for something to do, fires due timers, handles every
+		// pending event and draws the windows that are due. Returns how many windows were drawn.
+		std::size_t runOnce(std::optional<std::chrono::milliseconds> maxWait = std::nullopt)
+		{
+			SDL_Event event;
+			const bool hasEvent = waitEvent(event, maxWait);
+			// Before dispatching, so timers added by event handlers count from the current time.
+			m_Wheel.update();
+			if (hasEvent)
+			{
+				handle(event);
+				while (sdl2::events::poll(event))
+				{
+					handle(event);
+				}
+				m_Windows.destroyClosed();
+			}
+			return m_Windows.render();
+		}
+
+		[[nodiscard]] bool isRunning()const noexcept { return m_IsRunning.load(std::memory_order_acquire); }
+
+		[[nodiscard]] std::uint64_t getWakeUps()const noexcept { return m_WakeUps; }
+
+		[[nodiscard]] std::uint32_t getWakeEventType()const noexcept { return m_WakeEvent; }
+
+	private:
+		static constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+
+		// Kept in a deque so the address handed to the wheel stays valid while timers are added.
+		struct Timer
+		{
+			EventLoop* loop = nullptr;
+			OnTimer onTimer;
+			TimerHandle handle;
+			std::uint32_t index = 0;
+			std::uint32_t nextFree = NONE;
+			bool isRepeating = false;
+		};
+
+		static void onWheelTimer(void* userData)
+		{
+			Timer& timer = *static_cast<Timer*>(userData);
+			EventLoop& loop = *timer.loop;
+			loop.m_FiringTimer = timer.index;
+			timer.onTimer();
+			loop.m_FiringTimer = NONE;
+			// The wheel releases its node after this returns unless the timer repeats.
+			if (!timer.isRepeating || !loop.m_Wheel.isActive(timer.handle))
+			{
+				loop.releaseTimer(timer.index);
+			}
+		}
+
+		void releaseTimer(std::uint32_t index)noexcept
+		{
+			Timer& timer = m_Timers[index];
+			timer.onTimer = nullptr;
+			// The node may already carry a timer added by the callback that cancelled this one.
+			if (m_TimerByNode[timer.handle.index] == index)
+			{
+				m_TimerByNode[timer.handle.index] = NONE;
+			}
+			timer.handle = TimerHandle{};
+			timer.nextFree = m_FreeTimer;
+			m_FreeTimer = index;
+		}
+
+		void wake()
+		{
+			if (!m_IsWakePending.exchange(true, std::memory_order_acq_rel))
+			{
+				SDL_Event event{};
+				event.type = m_WakeEvent;
+				// A full or filtered queue drops the event; let the next call try again.
+				if (sdl2::events::push(&event) != EventPushResult::SUCCESS)
+				{
+					m_IsWakePending.store(false, std::memory_order_release);
+				}
+			}
+		}
+
+		[[nodiscard]] std::optional<Clock::time_point> getNextDeadline()const
+		{
+			std::optional<Clock::time_point> deadline = m_Windows.getNextDeadline();
+			if (const std::optional<std::chrono::microseconds> timeout = m_Wheel.getTimeout())
+			{
+				const Clock::time_point wheelDeadline = Clock::now() + *timeout;
+				if (!deadline || wheelDeadline < *deadline)
+				{
+					deadline = wheelDeadline;
+				}
+			}
+			return deadline;
+		}
+
+		[[nodiscard]] bool waitEvent(SDL_Event& event, std::optional<std::chrono::milliseconds> maxWait)
+		{
+			std::optional<std::chrono::milliseconds> timeout = maxWait;
+			if (const std::optional<Clock::time_point> deadline = getNextDeadline())
+			{
+				const Clock::time_point now = Clock::now();
+				// Rounded up so the loop does not wake just before the deadline and spin.
+				const auto untilDeadline = *deadline > now ? std::chrono::ceil<std::chrono::milliseconds>(*deadline - now) : std::chrono::milliseconds{ 0 };
+				timeout = timeout ? std::min(*timeout, untilDeadline) : untilDeadline;
+			}
+			++m_WakeUps;
+			if (!timeout)
+			{
+				return sdl2::events::wait(event);
+			}
+			if (timeout->count() <= 0)
+			{
+				return sdl2::events::poll(event);
+			}
+			return sdl2::events::wait(event, *timeout);
+		}
+
+		void handle(const SDL_Event& event)
+		{
+			if (event.type == m_WakeEvent)
+			{
+				m_IsWakePending.store(false, std::memory_order_release);
+				applyInvalidations();
+				return;
+			}
+			m_Windows.dispatch(event);
+			if (event.type == SDL_QUIT)
+			{
+				m_IsRunning.store(false, std::memory_order_release);
+			}
+		}
+
+		void applyInvalidations()
+		{
+			{
+				std::lock_guard lock{ m_InvalidMutex };
+				m_Applying.swap(m_InvalidWindows);
+			}
+			for (const std::uint32_t id : m_Applying)
+			{
+				if (id == 0)
+				{
+					m_Windows.invalidateAll();
+				}
+				else if (ManagedWindow* window = m_Windows.find(id); window != nullptr)
+				{
+					window->invalidate();
+				}
+			}
+			m_Applying.clear();
+		}
+
+		WindowManager& m_Windows;
+		TimerWheel m_Wheel;
+		std::uint32_t m_WakeEvent = SDL_USEREVENT;
+		std::atomic<bool> m_IsWakePending{ false };
+		std::atomic<bool> m_IsRunning{ false };
+		std::atomic<int> m_ExitCode{ 0 };
+		std::mutex m_InvalidMutex;
+		std::vector<std::uint32_t> m_InvalidWindows;
+		std::vector<std::uint32_t> m_Applying;
+		std::deque<Timer> m_Timers;
+		std::vector<std::uint32_t> m_TimerByNode;
+		std::uint32_t m_FreeTimer = NONE;
+		std::uint32_t m_FiringTimer = NONE;
+		std::uint64_t m_WakeUps = 0;
+	};
+}
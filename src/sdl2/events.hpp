@@ -1,9 +1,14 @@
 #pragma once
 
+#include "trace.hpp"
+
 #include <SDL_events.h>
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <chrono>
 #include <memory>
+#include <utility>
 
 namespace sdl2
 {
@@ -23,6 +28,7 @@ namespace sdl2
 
 	using EventFilter = SDL_EventFilter;
 	using EventWatch = SDL_EventFilter;
+	using EventHook = void(*)(const SDL_Event& event, void* userData);
 
 	namespace events
 	{
@@ -32,13 +38,38 @@ namespace sdl2
 			return SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, SDL_QUIT, SDL_QUIT);
 		}
 
-		inline void pump() { SDL_PumpEvents(); }
+		inline void pump()
+		{
+			SDL2_TRACE_SCOPE("events", "events::pump");
+			SDL_PumpEvents();
+		}
 
-		inline int add(std::vector<SDL_Event>& events, std::uint32_t minType, std::uint32_t maxType) { return SDL_PeepEvents(events.data(), events.size(), SDL_ADDEVENT, minType, maxType); }
+		template<class Allocator>
+		int add(std::vector<SDL_Event, Allocator>& events, std::uint32_t minType, std::uint32_t maxType) { return SDL_PeepEvents(events.data(), static_cast<int>(events.size()), SDL_ADDEVENT, minType, maxType); }
 
-		inline int peek(std::vector<SDL_Event>& events, std::uint32_t minType, std::uint32_t maxType) { return SDL_PeepEvents(events.data(), events.size(), SDL_PEEKEVENT, minType, maxType); }
+		template<class Allocator>
+		int peek(std::vector<SDL_Event, Allocator>& events, std::uint32_t minType, std::uint32_t maxType) { return SDL_PeepEvents(events.data(), static_cast<int>(events.size()), SDL_PEEKEVENT, minType, maxType); }
 
-		inline int get(std::vector<SDL_Event>& events, std::uint32_t minType, std::uint32_t maxType) { return SDL_PeepEvents(events.data(), events.size(), SDL_GETEVENT, minType, maxType); }
+		template<class Allocator>
+		int get(std::vector<SDL_Event, Allocator>& events, std::uint32_t minType, std::uint32_t maxType) { return SDL_PeepEvents(events.data(), static_cast<int>(events.size()), SDL_GETEVENT, minType, maxType); }
+
+		// Pumps and moves every pending event in the range into events, e.g. a std::pmr::vector backed by a FrameArena.
+		template<class Allocator>
+		int getAll(std::vector<SDL_Event, Allocator>& events, std::uint32_t minType = SDL_FIRSTEVENT, std::uint32_t maxType = SDL_LASTEVENT)
+		{
+			SDL2_TRACE_SCOPE("events", "events::getAll");
+			SDL_PumpEvents();
+			const int pending = SDL_PeepEvents(nullptr, 0, SDL_PEEKEVENT, minType, maxType);
+			if (pending <= 0)
+			{
+				events.clear();
+				return pending;
+			}
+			events.resize(static_cast<std::size_t>(pending));
+			const int count = get(events, minType, maxType);
+			events.resize(static_cast<std::size_t>(std::max(count, 0)));
+			return count;
+		}
 
 		[[nodiscard]] inline bool has() { return SDL_PollEvent(nullptr) == 1; }
 
@@ -50,9 +81,31 @@ namespace sdl2
 
 		inline void flush(std::uint32_t minType, std::uint32_t maxType) { SDL_FlushEvents(minType, maxType); }
 
+		[[nodiscard]] inline std::pair<sdl2::EventHook, void*>& getHook()noexcept
+		{
+			static std::pair<sdl2::EventHook, void*> hook{ nullptr, nullptr };
+			return hook;
+		}
+
+		// Sees every event handed out by poll(), pollAll() and wait(), e.g. to record a session.
+		// Unlike an event watch it runs when the application takes the event, not when SDL queues it.
+		inline void setHook(sdl2::EventHook hook, void* userData)noexcept { getHook() = std::make_pair(hook, userData); }
+
+		inline bool notify(SDL_Event& event, bool isTaken)
+		{
+			if (const auto& [hook, userData] = getHook(); isTaken && hook != nullptr)
+			{
+				hook(event, userData);
+			}
+			return isTaken;
+		}
+
+		inline bool poll(SDL_Event& event) { return notify(event, SDL_PollEvent(&event) == 1); }
+
 		template<class OnEvent, class... Args>
 		void pollAll(OnEvent&& onEvent, Args&&... args)
 		{
+			SDL2_TRACE_SCOPE("events", "events::pollAll");
 			SDL_Event event;
 			while (sdl2::events::poll(event))
 			{
@@ -60,11 +113,9 @@ namespace sdl2
 			}
 		}
 
-		inline bool poll(SDL_Event& event) { return SDL_PollEvent(&event) == 1; }
-
-		inline bool wait(SDL_Event& event) { return SDL_WaitEvent(&event) == 1; }
+		inline bool wait(SDL_Event& event) { return notify(event, SDL_WaitEvent(&event) == 1); }
 
-		inline bool wait(SDL_Event& event, std::chrono::milliseconds timeout) { return SDL_WaitEventTimeout(&event, timeout.count()) == 1; }
+		inline bool wait(SDL_Event& event, std::chrono::milliseconds timeout) { return notify(event, SDL_WaitEventTimeout(&event, timeout.count()) == 1); }
 
 		inline EventPushResult push(SDL_Event* event) { return static_cast<EventPushResult>(SDL_PushEvent(event)); }
 
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace sdl2
+{
+	// Bump allocator for data that lives for a single frame; use it through std::pmr containers.
+	// Deallocation is a no-op and reset() rewinds everything at once. When a frame needs more than
+	// the current block, the excess comes from the upstream resource and the next reset() merges
+	// it into one bigger block, so steady state frames never reach the upstream resource;
+	// getFrameUpstreamAllocations() shows whether that holds.
+	class FrameArena final : public std::pmr::memory_resource
+	{
+	public:
+		static constexpr std::size_t BLOCK_ALIGNMENT = 64;
+
+		[[nodiscard]] explicit FrameArena(std::size_t capacity = 1u << 20, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+			: m_Upstream(upstream)
+		{
+			allocateBlock(std::max<std::size_t>(capacity, BLOCK_ALIGNMENT));
+		}
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		~FrameArena()override { releaseAll(); }
+
+		// Starts a new frame. Everything allocated so far becomes invalid.
+		void reset()
+		{
+			if (!m_Overflow.empty())
+			{
+				const std::size_t needed = m_Capacity + m_OverflowBytes;
+				releaseAll();
+				allocateBlock(roundUp(needed));
+			}
+			m_Offset = 0;
+			m_FrameUpstreamAllocations = 0;
+		}
+
+		[[nodiscard]] std::size_t getCapacity()const noexcept { return m_Capacity; }
+
+		[[nodiscard]] std::size_t getUsedBytes()const noexcept { return m_Offset + m_OverflowBytes; }
+
+		[[nodiscard]] std::size_t getPeakBytes()const noexcept { return m_Peak; }
+
+		// Upstream allocations since the last reset(); stays 0 once the arena has grown to fit a frame.
+		[[nodiscard]] std::uint64_t getFrameUpstreamAllocations()const noexcept { return m_FrameUpstreamAllocations; }
+
+		[[nodiscard]] std::uint64_t getUpstreamAllocations()const noexcept { return m_UpstreamAllocations; }
+
+	private:
+		struct Block
+		{
+			void* data = nullptr;
+			std::size_t size = 0;
+			std::size_t alignment = 0;
+		};
+
+		void* do_allocate(std::size_t bytes, std::size_t alignment)override
+		{
+			const auto base = reinterpret_cast<std::uintptr_t>(m_Block);
+			const std::size_t aligned = ((base + m_Offset + alignment - 1) & ~(alignment - 1)) - base;
+			if (aligned + bytes <= m_Capacity)
+			{
+				m_Offset = aligned + bytes;
+				m_Peak = std::max(m_Peak, getUsedBytes());
+				return m_Block + aligned;
+			}
+			m_Overflow.reserve(m_Overflow.size() + 1);
+			void* data = m_Upstream->allocate(bytes, alignment);
+			m_Overflow.push_back(Block{ data, bytes, alignment });
+			m_OverflowBytes += bytes;
+			m_Peak = std::max(m_Peak, getUsedBytes());
+			++m_UpstreamAllocations;
+			++m_FrameUpstreamAllocations;
+			return data;
+		}
+
+		void do_deallocate(void*, std::size_t, std::size_t)override {}
+
+		bool do_is_equal(const std::pmr::memory_resource& other)const noexcept override { return this == &other; }
+
+		[[nodiscard]] static constexpr std::size_t roundUp(std::size_t bytes)noexcept
+		{
+			std::size_t size = BLOCK_ALIGNMENT;
+			while (size < bytes)
+			{
+				size <<= 1;
+			}
+			return size;
+		}
+
+		void allocateBlock(std::size_t capacity)
+		{
+			m_Block = static_cast<std::byte*>(m_Upstream->allocate(capacity, BLOCK_ALIGNMENT));
+			m_Capacity = capacity;
+			++m_UpstreamAllocations;
+		}
+
+		void releaseAll()noexcept
+		{
+			for (const Block& block : m_Overflow)
+			{
+				m_Upstream->deallocate(block.data, block.size, block.alignment);
+			}
+			m_Overflow.clear();
+			m_OverflowBytes = 0;
+			if (m_Block != nullptr)
+			{
+				m_Upstream->deallocate(m_Block, m_Capacity, BLOCK_ALIGNMENT);
+				m_Block = nullptr;
+				m_Capacity = 0;
+			}
+		}
+
+		std::pmr::memory_resource* m_Upstream;
+		std::byte* m_Block = nullptr;
+		std::size_t m_Capacity = 0;
+		std::size_t m_Offset = 0;
+		std::vector<Block> m_Overflow;
+		std::size_t m_OverflowBytes = 0;
+		std::size_t m_Peak = 0;
+		std::uint64_t m_UpstreamAllocations = 0;
+		std::uint64_t m_FrameUpstreamAllocations = 0;
+	};
+}
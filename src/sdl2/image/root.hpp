@@ -4,6 +4,7 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <SDL_assert.h>
 #include <SDL_image.h>
 
 namespace sdl2::image
@@ -29,7 +30,7 @@ namespace sdl2::image
 	template <typename... Flags>
 	bool init(Flags... flags) noexcept
 	{
-		static_assert( ( std::is_same<Flags, IMGFlags>() && ... ) );
+		static_assert( ( std::is_same<Flags, IMGFlag>() && ... ) );
 		return sdl2::image::init( ( flags | ... ) );
 	}
 
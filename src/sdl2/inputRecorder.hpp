@@ -0,0 +1,648 @@
+#pragma once
+
+#include "events.hpp"
+
+#include <SDL_events.h>
+#include <SDL_rwops.h>
+#include <SDL_stdinc.h>
+#include <SDL_version.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sdl2
+{
+	// Makes the next SDL_Init open no window system and no audio device, for headless replays.
+	inline void useDummyDrivers(bool audio = true)
+	{
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		if (audio)
+		{
+			SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+		}
+	}
+
+	namespace detail
+	{
+		// Binary log layout: "INP1" magic, then per event a varint frame delta, a varint event type
+		// and the fields of that type as varints (zigzag for signed values). Timestamps are not
+		// stored; SDL stamps replayed events again when they are pushed.
+		class InputLogCodec
+		{
+		public:
+			static constexpr std::uint32_t MAGIC = 0x31504E49; // "INP1"
+
+			// Returns false for events that cannot be stored: system and user events carry pointers.
+			static bool encode(std::vector<std::uint8_t>& out, const SDL_Event& event)
+			{
+				Writer writer{ out };
+				switch (event.type)
+				{
+				case SDL_KEYDOWN:
+				case SDL_KEYUP:
+					writer.write(event.type);
+					writer.write(event.key.windowID);
+					writer.write(event.key.state);
+					writer.write(event.key.repeat);
+					writer.write(static_cast<std::uint32_t>(event.key.keysym.scancode));
+					writer.write(static_cast<std::uint32_t>(event.key.keysym.sym));
+					writer.write(event.key.keysym.mod);
+					return true;
+				case SDL_MOUSEMOTION:
+					writer.write(event.type);
+					writer.write(event.motion.windowID);
+					writer.write(event.motion.which);
+					writer.write(event.motion.state);
+					writer.writeSigned(event.motion.x);
+					writer.writeSigned(event.motion.y);
+					writer.writeSigned(event.motion.xrel);
+					writer.writeSigned(event.motion.yrel);
+					return true;
+				case SDL_MOUSEBUTTONDOWN:
+				case SDL_MOUSEBUTTONUP:
+					writer.write(event.type);
+					writer.write(event.button.windowID);
+					writer.write(event.button.which);
+					writer.write(event.button.button);
+					writer.write(event.button.state);
+					writer.write(event.button.clicks);
+					writer.writeSigned(event.button.x);
+					writer.writeSigned(event.button.y);
+					return true;
+				case SDL_MOUSEWHEEL:
+					writer.write(event.type);
+					writer.write(event.wheel.windowID);
+					writer.write(event.wheel.which);
+					writer.writeSigned(event.wheel.x);
+					writer.writeSigned(event.wheel.y);
+					writer.write(event.wheel.direction);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+					writer.write(event.wheel.preciseX);
+					writer.write(event.wheel.preciseY);
+#endif
+					return true;
+				case SDL_CONTROLLERAXISMOTION:
+					writer.write(event.type);
+					writer.writeSigned(event.caxis.which);
+					writer.write(event.caxis.axis);
+					writer.writeSigned(event.caxis.value);
+					return true;
+				case SDL_CONTROLLERBUTTONDOWN:
+				case SDL_CONTROLLERBUTTONUP:
+					writer.write(event.type);
+					writer.writeSigned(event.cbutton.which);
+					writer.write(event.cbutton.button);
+					writer.write(event.cbutton.state);
+					return true;
+				case SDL_CONTROLLERDEVICEADDED:
+				case SDL_CONTROLLERDEVICEREMOVED:
+				case SDL_CONTROLLERDEVICEREMAPPED:
+					writer.write(event.type);
+					writer.writeSigned(event.cdevice.which);
+					return true;
+				case SDL_WINDOWEVENT:
+					writer.write(event.type);
+					writer.write(event.window.windowID);
+					writer.write(event.window.event);
+					writer.writeSigned(event.window.data1);
+					writer.writeSigned(event.window.data2);
+					return true;
+				case SDL_TEXTINPUT:
+					writer.write(event.type);
+					writer.write(event.text.windowID);
+					writer.write(event.text.text);
+					return true;
+				case SDL_TEXTEDITING:
+					writer.write(event.type);
+					writer.write(event.edit.windowID);
+					writer.write(event.edit.text);
+					writer.writeSigned(event.edit.start);
+					writer.writeSigned(event.edit.length);
+					return true;
+#if SDL_VERSION_ATLEAST(2, 0, 22)
+				case SDL_TEXTEDITING_EXT:
+					writer.write(event.type);
+					writer.write(event.editExt.windowID);
+					writer.write(event.editExt.text != nullptr ? event.editExt.text : "");
+					writer.writeSigned(event.editExt.start);
+					writer.writeSigned(event.editExt.length);
+					return true;
+#endif
+				case SDL_DROPFILE:
+				case SDL_DROPTEXT:
+				case SDL_DROPBEGIN:
+				case SDL_DROPCOMPLETE:
+					writer.write(event.type);
+					writer.write(event.drop.windowID);
+					writer.write(event.drop.file != nullptr ? event.drop.file : "");
+					return true;
+				case SDL_SYSWMEVENT:
+					return false;
+				default:
+					if (event.type >= SDL_USEREVENT)
+					{
+						return false;
+					}
+					// Remaining types are plain data; keep them whole.
+					writer.write(event.type);
+					writer.writeBytes(&event, sizeof(SDL_Event));
+					return true;
+				}
+			}
+
+			// Drop and long text editing events get their text copied with SDL_strdup; as with live
+			// events, the application frees it with SDL_free.
+			static bool decode(const std::uint8_t*& data, const std::uint8_t* end, SDL_Event& event)
+			{
+				Reader reader{ data, end };
+				event = SDL_Event{};
+				event.type = reader.read<std::uint32_t>();
+				switch (event.type)
+				{
+				case SDL_KEYDOWN:
+				case SDL_KEYUP:
+					event.key.windowID = reader.read<std::uint32_t>();
+					event.key.state = reader.read<std::uint8_t>();
+					event.key.repeat = reader.read<std::uint8_t>();
+					event.key.keysym.scancode = static_cast<SDL_Scancode>(reader.read<std::uint32_t>());
+					event.key.keysym.sym = static_cast<SDL_Keycode>(reader.read<std::uint32_t>());
+					event.key.keysym.mod = reader.read<std::uint16_t>();
+					break;
+				case SDL_MOUSEMOTION:
+					event.motion.windowID = reader.read<std::uint32_t>();
+					event.motion.which = reader.read<std::uint32_t>();
+					event.motion.state = reader.read<std::uint32_t>();
+					event.motion.x = reader.readSigned();
+					event.motion.y = reader.readSigned();
+					event.motion.xrel = reader.readSigned();
+					event.motion.yrel = reader.readSigned();
+					break;
+				case SDL_MOUSEBUTTONDOWN:
+				case SDL_MOUSEBUTTONUP:
+					event.button.windowID = reader.read<std::uint32_t>();
+					event.button.which = reader.read<std::uint32_t>();
+					event.button.button = reader.read<std::uint8_t>();
+					event.button.state = reader.read<std::uint8_t>();
+					event.button.clicks = reader.read<std::uint8_t>();
+					event.button.x = reader.readSigned();
+					event.button.y = reader.readSigned();
+					break;
+				case SDL_MOUSEWHEEL:
+					event.wheel.windowID = reader.read<std::uint32_t>();
+					event.wheel.which = reader.read<std::uint32_t>();
+					event.wheel.x = reader.readSigned();
+					event.wheel.y = reader.readSigned();
+					event.wheel.direction = reader.read<std::uint32_t>();
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+					event.wheel.preciseX = reader.readFloat();
+					event.wheel.preciseY = reader.readFloat();
+#endif
+					break;
+				case SDL_CONTROLLERAXISMOTION:
+					event.caxis.which = reader.readSigned();
+					event.caxis.axis = reader.read<std::uint8_t>();
+					event.caxis.value = static_cast<Sint16>(reader.readSigned());
+					break;
+				case SDL_CONTROLLERBUTTONDOWN:
+				case SDL_CONTROLLERBUTTONUP:
+					event.cbutton.which = reader.readSigned();
+					event.cbutton.button = reader.read<std::uint8_t>();
+					event.cbutton.state = reader.read<std::uint8_t>();
+					break;
+				case SDL_CONTROLLERDEVICEADDED:
+				case SDL_CONTROLLERDEVICEREMOVED:
+				case SDL_CONTROLLERDEVICEREMAPPED:
+					event.cdevice.which = reader.readSigned();
+					break;
+				case SDL_WINDOWEVENT:
+					event.window.windowID = reader.read<std::uint32_t>();
+					event.window.event = reader.read<std::uint8_t>();
+					event.window.data1 = reader.readSigned();
+					event.window.data2 = reader.readSigned();
+					break;
+				case SDL_TEXTINPUT:
+					event.text.windowID = reader.read<std::uint32_t>();
+					reader.readText(event.text.text, sizeof(event.text.text));
+					break;
+				case SDL_TEXTEDITING:
+					event.edit.windowID = reader.read<std::uint32_t>();
+					reader.readText(event.edit.text, sizeof(event.edit.text));
+					event.edit.start = reader.readSigned();
+					event.edit.length = reader.readSigned();
+					break;
+#if SDL_VERSION_ATLEAST(2, 0, 22)
+				case SDL_TEXTEDITING_EXT:
+				{
+					event.editExt.windowID = reader.read<std::uint32_t>();
+					const std::string text = reader.readString();
+					event.editExt.start = reader.readSigned();
+					event.editExt.length = reader.readSigned();
+					event.editExt.text = reader.isValid() ? SDL_strdup(text.c_str()) : nullptr;
+					break;
+				}
+#endif
+				case SDL_DROPFILE:
+				case SDL_DROPTEXT:
+				case SDL_DROPBEGIN:
+				case SDL_DROPCOMPLETE:
+				{
+					event.drop.windowID = reader.read<std::uint32_t>();
+					const std::string file = reader.readString();
+					event.drop.file = file.empty() ? nullptr : SDL_strdup(file.c_str());
+					break;
+				}
+				default:
+				{
+					const std::uint32_t type = event.type;
+					reader.readBytes(&event, sizeof(SDL_Event));
+					event.type = type;
+					break;
+				}
+				}
+				data = reader.getPosition();
+				return reader.isValid();
+			}
+
+			static void writeVarint(std::vector<std::uint8_t>& out, std::uint64_t value)
+			{
+				Writer{ out }.writeVarint(value);
+			}
+
+			[[nodiscard]] static bool readVarint(const std::uint8_t*& data, const std::uint8_t* end, std::uint64_t& value)
+			{
+				Reader reader{ data, end };
+				value = reader.readVarint();
+				data = reader.getPosition();
+				return reader.isValid();
+			}
+
+		private:
+			struct Writer
+			{
+				std::vector<std::uint8_t>& out;
+
+				void writeVarint(std::uint64_t value)
+				{
+					while (value >= 0x80)
+					{
+						out.push_back(static_cast<std::uint8_t>(value | 0x80));
+						value >>= 7;
+					}
+					out.push_back(static_cast<std::uint8_t>(value));
+				}
+
+				template<class T>
+				void write(T value) { writeVarint(static_cast<std::uint64_t>(value)); }
+
+				void write(float value)
+				{
+					std::uint32_t bits = 0;
+					std::memcpy(&bits, &value, sizeof(bits));
+					writeVarint(bits);
+				}
+
+				void write(const char* text)
+				{
+					const std::size_t length = SDL_strlen(text);
+					writeVarint(length);
+					writeBytes(text, length);
+				}
+
+				void writeSigned(std::int64_t value) { writeVarint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63)); }
+
+				void writeBytes(const void* data, std::size_t size)
+				{
+					const auto* bytes = static_cast<const std::uint8_t*>(data);
+					out.insert(out.end(), bytes, bytes + size);
+				}
+			};
+
+			class Reader
+			{
+			public:
+				Reader(const std::uint8_t* data, const std::uint8_t* end)noexcept
+					: m_Data(data)
+					, m_End(end)
+				{}
+
+				std::uint64_t readVarint()noexcept
+				{
+					std::uint64_t value = 0;
+					for (unsigned shift = 0; shift < 64; shift += 7)
+					{
+						if (m_Data == m_End)
+						{
+							m_IsValid = false;
+							return 0;
+						}
+						const std::uint8_t byte = *m_Data++;
+						value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+						if ((byte & 0x80) == 0)
+						{
+							return value;
+						}
+					}
+					m_IsValid = false;
+					return value;
+				}
+
+				template<class T>
+				T read()noexcept { return static_cast<T>(readVarint()); }
+
+				std::int32_t readSigned()noexcept
+				{
+					const std::uint64_t value = readVarint();
+					return static_cast<std::int32_t>(static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1));
+				}
+
+				float readFloat()noexcept
+				{
+					const auto bits = static_cast<std::uint32_t>(readVarint());
+					float value = 0.0f;
+					std::memcpy(&value, &bits, sizeof(value));
+					return value;
+				}
+
+				void readBytes(void* data, std::size_t size)noexcept
+				{
+					if (static_cast<std::size_t>(m_End - m_Data) < size)
+					{
+						m_IsValid = false;
+						m_Data = m_End;
+						return;
+					}
+					std::memcpy(data, m_Data, size);
+					m_Data += size;
+				}
+
+				void readText(char* text, std::size_t capacity)noexcept
+				{
+					const std::uint64_t length = readVarint();
+					if (length >= capacity)
+					{
+						m_IsValid = false;
+						return;
+					}
+					readBytes(text, length);
+					text[length] = '\0';
+				}
+
+				std::string readString()
+				{
+					const std::uint64_t length = readVarint();
+					if (static_cast<std::size_t>(m_End - m_Data) < length)
+					{
+						m_IsValid = false;
+						return {};
+					}
+					std::string text(reinterpret_cast<const char*>(m_Data), length);
+					m_Data += length;
+					return text;
+				}
+
+				[[nodiscard]] const std::uint8_t* getPosition()const noexcept { return m_Data; }
+
+				[[nodiscard]] bool isValid()const noexcept { return m_IsValid; }
+
+			private:
+				const std::uint8_t* m_Data;
+				const std::uint8_t* m_End;
+				bool m_IsValid = true;
+			};
+		};
+	}
+
+	// Records the events an application takes from the queue, tagged with the index of the
+	// fixed timestep they were handled in, into a compact binary log for InputReplayer.
+	// start() hooks into events::poll/pollAll/wait; applications with their own pump can call
+	// record() directly. Call nextFrame() once per simulation step.
+	class InputRecorder
+	{
+	public:
+		[[nodiscard]] InputRecorder() = default;
+
+		InputRecorder(const InputRecorder&) = delete;
+		InputRecorder& operator=(const InputRecorder&) = delete;
+
+		~InputRecorder() { stop(); }
+
+		bool start(const std::string& file, bool hookEvents = true)
+		{
+			stop();
+			m_File = SDL_RWFromFile(file.c_str(), "wb");
+			if (m_File == nullptr)
+			{
+				return false;
+			}
+			m_Buffer.clear();
+			m_Frame = 0;
+			m_LastFrame = 0;
+			m_EventsCount = 0;
+			m_BytesWritten = 0;
+			if (SDL_WriteLE32(m_File, detail::InputLogCodec::MAGIC) != 1)
+			{
+				stop();
+				return false;
+			}
+			m_BytesWritten = 4;
+			if (hookEvents)
+			{
+				m_Previous = sdl2::events::getHook();
+				sdl2::events::setHook(&InputRecorder::onEvent, this);
+				m_IsHooked = true;
+			}
+			return true;
+		}
+
+		// Flushes and closes the log.
+		bool stop()
+		{
+			if (m_IsHooked)
+			{
+				sdl2::events::setHook(m_Previous.first, m_Previous.second);
+				m_IsHooked = false;
+			}
+			if (m_File == nullptr)
+			{
+				return false;
+			}
+			const bool success = flush();
+			const bool isClosed = SDL_RWclose(m_File) == 0;
+			m_File = nullptr;
+			return success && isClosed;
+		}
+
+		void record(const SDL_Event& event)
+		{
+			if (m_File == nullptr)
+			{
+				return;
+			}
+			const std::size_t mark = m_Buffer.size();
+			detail::InputLogCodec::writeVarint(m_Buffer, m_Frame - m_LastFrame);
+			if (!detail::InputLogCodec::encode(m_Buffer, event))
+			{
+				m_Buffer.resize(mark);
+				return;
+			}
+			m_LastFrame = m_Frame;
+			++m_EventsCount;
+			if (m_Buffer.size() >= FLUSH_SIZE)
+			{
+				flush();
+			}
+		}
+
+		void nextFrame()noexcept { ++m_Frame; }
+
+		[[nodiscard]] bool isRecording()const noexcept { return m_File != nullptr; }
+
+		[[nodiscard]] std::uint64_t getFrame()const noexcept { return m_Frame; }
+
+		[[nodiscard]] std::uint64_t getEventsCount()const noexcept { return m_EventsCount; }
+
+		[[nodiscard]] std::uint64_t getBytesWritten()const noexcept { return m_BytesWritten + m_Buffer.size(); }
+
+	private:
+		static constexpr std::size_t FLUSH_SIZE = 64 * 1024;
+
+		static void onEvent(const SDL_Event& event, void* userData)
+		{
+			auto* recorder = static_cast<InputRecorder*>(userData);
+			recorder->record(event);
+			if (recorder->m_Previous.first != nullptr)
+			{
+				recorder->m_Previous.first(event, recorder->m_Previous.second);
+			}
+		}
+
+		bool flush()
+		{
+			if (m_Buffer.empty())
+			{
+				return true;
+			}
+			const bool success = SDL_RWwrite(m_File, m_Buffer.data(), 1, m_Buffer.size()) == m_Buffer.size();
+			m_BytesWritten += m_Buffer.size();
+			m_Buffer.clear();
+			return success;
+		}
+
+		SDL_RWops* m_File = nullptr;
+		std::vector<std::uint8_t> m_Buffer;
+		std::pair<sdl2::EventHook, void*> m_Previous{ nullptr, nullptr };
+		bool m_IsHooked = false;
+		std::uint64_t m_Frame = 0;
+		std::uint64_t m_LastFrame = 0;
+		std::uint64_t m_EventsCount = 0;
+		std::uint64_t m_BytesWritten = 0;
+	};
+
+	// Plays an InputRecorder log back in lock-step with the fixed timestep. Either push each
+	// frame into SDL's queue with pushFrame() before the usual event handling, or use poll() as
+	// the event pump; then call nextFrame() once per simulation step. Window ids are replayed as
+	// recorded, which matches as long as windows are created in the same order.
+	class InputReplayer
+	{
+	public:
+		[[nodiscard]] InputReplayer() = default;
+
+		bool open(const std::string& file)
+		{
+			m_Data.clear();
+			m_Position = 0;
+			m_Frame = 0;
+			m_IsValid = false;
+			SDL_RWops* rw = SDL_RWFromFile(file.c_str(), "rb");
+			if (rw == nullptr)
+			{
+				return false;
+			}
+			const Sint64 size = SDL_RWsize(rw);
+			bool success = size >= 4 && SDL_ReadLE32(rw) == detail::InputLogCodec::MAGIC;
+			if (success)
+			{
+				m_Data.resize(static_cast<std::size_t>(size - 4));
+				success = SDL_RWread(rw, m_Data.data(), 1, m_Data.size()) == m_Data.size();
+			}
+			SDL_RWclose(rw);
+			m_IsValid = success;
+			m_NextFrame = 0;
+			return success && readFrameDelta();
+		}
+
+		// Pushes the events of the current frame into SDL's queue and advances to the next frame.
+		// Returns how many events were pushed.
+		std::size_t pushFrame()
+		{
+			std::size_t pushed = 0;
+			SDL_Event event;
+			while (poll(event))
+			{
+				sdl2::events::push(&event);
+				++pushed;
+			}
+			nextFrame();
+			return pushed;
+		}
+
+		// Next recorded event of the current frame, without touching SDL's queue.
+		bool poll(SDL_Event& event)
+		{
+			if (!m_IsValid || m_Position >= m_Data.size() || m_NextFrame > m_Frame)
+			{
+				return false;
+			}
+			const std::uint8_t* data = m_Data.data() + m_Position;
+			const std::uint8_t* end = m_Data.data() + m_Data.size();
+			if (!detail::InputLogCodec::decode(data, end, event))
+			{
+				m_IsValid = false;
+				return false;
+			}
+			m_Position = static_cast<std::size_t>(data - m_Data.data());
+			++m_EventsCount;
+			readFrameDelta();
+			return true;
+		}
+
+		void nextFrame()noexcept { ++m_Frame; }
+
+		[[nodiscard]] bool isFinished()const noexcept { return !m_IsValid || m_Position >= m_Data.size(); }
+
+		[[nodiscard]] bool isValid()const noexcept { return m_IsValid; }
+
+		[[nodiscard]] std::uint64_t getFrame()const noexcept { return m_Frame; }
+
+		[[nodiscard]] std::uint64_t getEventsCount()const noexcept { return m_EventsCount; }
+
+	private:
+		bool readFrameDelta()
+		{
+			if (m_Position >= m_Data.size())
+			{
+				return true;
+			}
+			const std::uint8_t* data = m_Data.data() + m_Position;
+			std::uint64_t delta = 0;
+			if (!detail::InputLogCodec::readVarint(data, m_Data.data() + m_Data.size(), delta))
+			{
+				m_IsValid = false;
+				return false;
+			}
+			m_Position = static_cast<std::size_t>(data - m_Data.data());
+			m_NextFrame += delta;
+			return true;
+		}
+
+		std::vector<std::uint8_t> m_Data;
+		std::size_t m_Position = 0;
+		std::uint64_t m_Frame = 0;
+		std::uint64_t m_NextFrame = 0;
+		std::uint64_t m_EventsCount = 0;
+		bool m_IsValid = false;
+	};
+}
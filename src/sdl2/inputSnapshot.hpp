@@ -0,0 +1,306 @@
+#pragma once
+
+#include "tripleBuffer.hpp"
+
+#include <SDL_events.h>
+#include <SDL_gamecontroller.h>
+#include <SDL_mouse.h>
+#include <SDL_scancode.h>
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+namespace sdl2
+{
+	// Complete input state of one frame, plain data that can be copied to another thread.
+	// Edges cover everything since the previous snapshot the reader acquired, so a key pressed and
+	// released within one frame, or within frames the reader skipped, still reports wasPressed()
+	// and wasReleased(). All queries are O(1).
+	class InputSnapshot
+	{
+	public:
+		static constexpr std::size_t MAX_CONTROLLERS = 4;
+
+		struct Controller
+		{
+			SDL_JoystickID instance = -1;
+			std::uint32_t buttons = 0;
+			std::uint32_t pressed = 0;
+			std::uint32_t released = 0;
+			std::array<float, SDL_CONTROLLER_AXIS_MAX> axes{};
+		};
+
+		[[nodiscard]] bool isDown(SDL_Scancode key)const noexcept { return m_Keys.test(static_cast<std::size_t>(key)); }
+		[[nodiscard]] bool wasPressed(SDL_Scancode key)const noexcept { return m_KeysPressed.test(static_cast<std::size_t>(key)); }
+		[[nodiscard]] bool wasReleased(SDL_Scancode key)const noexcept { return m_KeysReleased.test(static_cast<std::size_t>(key)); }
+
+		// Mouse buttons use SDL numbering, SDL_BUTTON_LEFT and so on.
+		[[nodiscard]] bool isButtonDown(std::uint8_t button)const noexcept { return (m_Buttons & getMask(button)) != 0; }
+		[[nodiscard]] bool wasButtonPressed(std::uint8_t button)const noexcept { return (m_ButtonsPressed & getMask(button)) != 0; }
+		[[nodiscard]] bool wasButtonReleased(std::uint8_t button)const noexcept { return (m_ButtonsReleased & getMask(button)) != 0; }
+
+		[[nodiscard]] bool isDown(std::size_t controller, SDL_GameControllerButton button)const noexcept { return (m_Controllers[controller].buttons & getMask(button)) != 0; }
+		[[nodiscard]] bool wasPressed(std::size_t controller, SDL_GameControllerButton button)const noexcept { return (m_Controllers[controller].pressed & getMask(button)) != 0; }
+		[[nodiscard]] bool wasReleased(std::size_t controller, SDL_GameControllerButton button)const noexcept { return (m_Controllers[controller].released & getMask(button)) != 0; }
+
+		// Normalized to [-1, 1], triggers to [0, 1].
+		[[nodiscard]] float getAxis(std::size_t controller, SDL_GameControllerAxis axis)const noexcept { return m_Controllers[controller].axes[static_cast<std::size_t>(axis)]; }
+
+		[[nodiscard]] bool isConnected(std::size_t controller)const noexcept { return m_Controllers[controller].instance >= 0; }
+
+		[[nodiscard]] const Controller& getController(std::size_t controller)const noexcept { return m_Controllers[controller]; }
+
+		[[nodiscard]] SDL_Point getPointer()const noexcept { return m_Pointer; }
+
+		// Relative motion and wheel are summed over the frame.
+		[[nodiscard]] SDL_Point getPointerMotion()const noexcept { return m_PointerMotion; }
+		[[nodiscard]] SDL_FPoint getWheel()const noexcept { return m_Wheel; }
+
+		[[nodiscard]] std::uint16_t getModifiers()const noexcept { return m_Modifiers; }
+
+		[[nodiscard]] std::uint32_t getPointerWindow()const noexcept { return m_PointerWindow; }
+
+		[[nodiscard]] bool isQuitRequested()const noexcept { return m_IsQuitRequested; }
+
+		[[nodiscard]] std::uint64_t getFrame()const noexcept { return m_Frame; }
+
+		// SDL timestamp of the last event folded into this snapshot.
+		[[nodiscard]] std::uint32_t getTimestamp()const noexcept { return m_Timestamp; }
+
+	private:
+		friend class InputCollector;
+
+		[[nodiscard]] static constexpr std::uint32_t getMask(int bit)noexcept { return bit >= 0 && bit < 32 ? std::uint32_t{ 1 } << bit : 0; }
+
+		// Adds the edges, motion and wheel of other, an earlier snapshot.
+		void addEdges(const InputSnapshot& other)noexcept
+		{
+			m_KeysPressed |= other.m_KeysPressed;
+			m_KeysReleased |= other.m_KeysReleased;
+			m_ButtonsPressed |= other.m_ButtonsPressed;
+			m_ButtonsReleased |= other.m_ButtonsReleased;
+			for (std::size_t i = 0; i < MAX_CONTROLLERS; ++i)
+			{
+				m_Controllers[i].pressed |= other.m_Controllers[i].pressed;
+				m_Controllers[i].released |= other.m_Controllers[i].released;
+			}
+			m_PointerMotion.x += other.m_PointerMotion.x;
+			m_PointerMotion.y += other.m_PointerMotion.y;
+			m_Wheel.x += other.m_Wheel.x;
+			m_Wheel.y += other.m_Wheel.y;
+		}
+
+		void clearEdges()noexcept
+		{
+			m_KeysPressed.reset();
+			m_KeysReleased.reset();
+			m_ButtonsPressed = 0;
+			m_ButtonsReleased = 0;
+			for (Controller& controller : m_Controllers)
+			{
+				controller.pressed = 0;
+				controller.released = 0;
+			}
+			m_PointerMotion = SDL_Point{ 0, 0 };
+			m_Wheel = SDL_FPoint{ 0.0f, 0.0f };
+		}
+
+		std::bitset<SDL_NUM_SCANCODES> m_Keys;
+		std::bitset<SDL_NUM_SCANCODES> m_KeysPressed;
+		std::bitset<SDL_NUM_SCANCODES> m_KeysReleased;
+		std::uint32_t m_Buttons = 0;
+		std::uint32_t m_ButtonsPressed = 0;
+		std::uint32_t m_ButtonsReleased = 0;
+		std::array<Controller, MAX_CONTROLLERS> m_Controllers{};
+		SDL_Point m_Pointer{ 0, 0 };
+		SDL_Point m_PointerMotion{ 0, 0 };
+		SDL_FPoint m_Wheel{ 0.0f, 0.0f };
+		std::uint16_t m_Modifiers = 0;
+		std::uint32_t m_PointerWindow = 0;
+		bool m_IsQuitRequested = false;
+		std::uint64_t m_Frame = 0;
+		std::uint32_t m_Timestamp = 0;
+	};
+
+	// Builds InputSnapshots from events on the main thread and publishes one per frame to a
+	// simulation thread through a TripleBuffer:
+	//   main thread:       collector.handle(event) for each event, then collector.publish()
+	//   simulation thread: collector.acquire() and read the returned snapshot
+	// Nothing allocates after construction and neither thread ever blocks the other.
+	class InputCollector
+	{
+	public:
+		[[nodiscard]] InputCollector() = default;
+
+		InputCollector(const InputCollector&) = delete;
+		InputCollector& operator=(const InputCollector&) = delete;
+
+		// Main thread.
+		void handle(const SDL_Event& event)noexcept
+		{
+			InputSnapshot& state = m_State;
+			state.m_Timestamp = event.common.timestamp;
+			switch (event.type)
+			{
+			case SDL_KEYDOWN:
+			case SDL_KEYUP:
+			{
+				const auto key = static_cast<std::size_t>(event.key.keysym.scancode);
+				state.m_Modifiers = event.key.keysym.mod;
+				if (key >= SDL_NUM_SCANCODES || event.key.repeat != 0)
+				{
+					break;
+				}
+				const bool isDown = event.type == SDL_KEYDOWN;
+				if (state.m_Keys.test(key) != isDown)
+				{
+					state.m_Keys.set(key, isDown);
+					(isDown ? state.m_KeysPressed : state.m_KeysReleased).set(key);
+				}
+				break;
+			}
+			case SDL_MOUSEBUTTONDOWN:
+			case SDL_MOUSEBUTTONUP:
+			{
+				const std::uint32_t mask = InputSnapshot::getMask(event.button.button);
+				if (event.type == SDL_MOUSEBUTTONDOWN)
+				{
+					state.m_ButtonsPressed |= mask & ~state.m_Buttons;
+					state.m_Buttons |= mask;
+				}
+				else
+				{
+					state.m_ButtonsReleased |= mask & state.m_Buttons;
+					state.m_Buttons &= ~mask;
+				}
+				state.m_Pointer = SDL_Point{ event.button.x, event.button.y };
+				break;
+			}
+			case SDL_MOUSEMOTION:
+				state.m_Pointer = SDL_Point{ event.motion.x, event.motion.y };
+				state.m_PointerMotion.x += event.motion.xrel;
+				state.m_PointerMotion.y += event.motion.yrel;
+				state.m_PointerWindow = event.motion.windowID;
+				break;
+			case SDL_MOUSEWHEEL:
+			{
+				const float direction = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -1.0f : 1.0f;
+				state.m_Wheel.x += static_cast<float>(event.wheel.x) * direction;
+				state.m_Wheel.y += static_cast<float>(event.wheel.y) * direction;
+				break;
+			}
+			case SDL_CONTROLLERBUTTONDOWN:
+			case SDL_CONTROLLERBUTTONUP:
+				if (InputSnapshot::Controller* controller = findController(event.cbutton.which, true); controller != nullptr)
+				{
+					const std::uint32_t mask = InputSnapshot::getMask(event.cbutton.button);
+					if (event.type == SDL_CONTROLLERBUTTONDOWN)
+					{
+						controller->pressed |= mask & ~controller->buttons;
+						controller->buttons |= mask;
+					}
+					else
+					{
+						controller->released |= mask & controller->buttons;
+						controller->buttons &= ~mask;
+					}
+				}
+				break;
+			case SDL_CONTROLLERAXISMOTION:
+				if (InputSnapshot::Controller* controller = findController(event.caxis.which, true); controller != nullptr && event.caxis.axis < SDL_CONTROLLER_AXIS_MAX)
+				{
+					controller->axes[event.caxis.axis] = event.caxis.value >= 0 ? static_cast<float>(event.caxis.value) / 32767.0f : static_cast<float>(event.caxis.value) / 32768.0f;
+				}
+				break;
+			case SDL_CONTROLLERDEVICEREMOVED:
+				if (InputSnapshot::Controller* controller = findController(event.cdevice.which, false); controller != nullptr)
+				{
+					controller->released |= controller->buttons;
+					controller->buttons = 0;
+					controller->axes.fill(0.0f);
+					controller->instance = -1;
+				}
+				break;
+			case SDL_WINDOWEVENT:
+				// Keys held while focus moves away never get their key up event.
+				if (event.window.event == SDL_WINDOWEVENT_FOCUS_LOST)
+				{
+					releaseAll();
+				}
+				break;
+			case SDL_QUIT:
+				state.m_IsQuitRequested = true;
+				break;
+			default:
+				break;
+			}
+		}
+
+		// Main thread: makes the state gathered so far visible to acquire() and starts a new frame.
+		// While the previous snapshot still waits unread, the new one replaces it and carries its
+		// edges as well, so a simulation thread slower than the main thread misses no tap.
+		void publish()noexcept
+		{
+			InputSnapshot& snapshot = m_Buffer.getWriteBuffer();
+			snapshot = m_State;
+			snapshot.addEdges(m_Unread);
+			if (m_Buffer.replace())
+			{
+				m_Unread.addEdges(m_State);
+			}
+			else
+			{
+				snapshot = m_State;
+				m_Buffer.publish();
+				m_Unread = m_State;
+			}
+			m_State.clearEdges();
+			++m_State.m_Frame;
+		}
+
+		// Simulation thread: the latest published snapshot; stays valid until the next acquire().
+		[[nodiscard]] const InputSnapshot& acquire()noexcept
+		{
+			m_Buffer.update();
+			return m_Buffer.getReadBuffer();
+		}
+
+		// Main thread: the state being built for the current frame.
+		[[nodiscard]] const InputSnapshot& getCurrent()const noexcept { return m_State; }
+
+	private:
+		[[nodiscard]] InputSnapshot::Controller* findController(SDL_JoystickID instance, bool assign)noexcept
+		{
+			InputSnapshot::Controller* free = nullptr;
+			for (InputSnapshot::Controller& controller : m_State.m_Controllers)
+			{
+				if (controller.instance == instance)
+				{
+					return &controller;
+				}
+				if (free == nullptr && controller.instance < 0)
+				{
+					free = &controller;
+				}
+			}
+			if (assign && free != nullptr)
+			{
+				free->instance = instance;
+			}
+			return assign ? free : nullptr;
+		}
+
+		void releaseAll()noexcept
+		{
+			m_State.m_KeysReleased |= m_State.m_Keys;
+			m_State.m_Keys.reset();
+			m_State.m_ButtonsReleased |= m_State.m_Buttons;
+			m_State.m_Buttons = 0;
+		}
+
+		InputSnapshot m_State;
+		// Edges of the last published snapshot, until the simulation thread picks it up.
+		InputSnapshot m_Unread;
+		TripleBuffer<InputSnapshot> m_Buffer;
+	};
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+// Accounting of the pixel memory held by Texture and Surface objects. Define
+// SDL2_ENABLE_MEMORY_STATS to build it into the wrappers; without it they carry no extra state
+// and the queries below report nothing.
+//
+//   { sdl2::memory::TagScope tag{ "ui" }; atlas = sdl2::Texture{ renderer, surface }; }
+//   sdl2::memory::setBudget(sdl2::MemoryResource::TEXTURE, 64 << 20, onOverBudget);
+//   const sdl2::MemoryUsage textures = sdl2::memory::getUsage(sdl2::MemoryResource::TEXTURE);
+
+#include <SDL_pixels.h>
+#include <SDL_surface.h>
+#ifdef SDL2_ENABLE_MEMORY_STATS
+	#include <algorithm>
+	#include <array>
+	#include <deque>
+	#include <mutex>
+	#include <string>
+	#include <utility>
+#endif
+#include <cstdint>
+#include <vector>
+
+namespace sdl2
+{
+	enum class MemoryResource : std::uint8_t
+	{
+		TEXTURE,
+		SURFACE
+	};
+
+	struct MemoryUsage
+	{
+		std::uint64_t bytes = 0;
+		std::uint64_t peakBytes = 0;
+		std::uint64_t count = 0;
+	};
+
+	struct MemoryTagUsage
+	{
+		const char* tag = nullptr;
+		MemoryUsage usage;
+	};
+
+	namespace memory
+	{
+		// Called on the allocating thread when the live bytes of resource go above budget.
+		using OnBudget = void(*)(MemoryResource resource, std::uint64_t bytes, std::uint64_t budget, void* userData);
+
+		// Approximate size of a texture; drivers may pad rows or keep a shadow copy on top.
+		[[nodiscard]] inline std::uint64_t getTextureBytes(std::uint32_t format, int w, int h)noexcept
+		{
+			if (w <= 0 || h <= 0)
+			{
+				return 0;
+			}
+			const auto width = static_cast<std::uint64_t>(w);
+			const auto height = static_cast<std::uint64_t>(h);
+			switch (format)
+			{
+			case SDL_PIXELFORMAT_YV12:
+			case SDL_PIXELFORMAT_IYUV:
+			case SDL_PIXELFORMAT_NV12:
+			case SDL_PIXELFORMAT_NV21:
+				return width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2);
+			case SDL_PIXELFORMAT_YUY2:
+			case SDL_PIXELFORMAT_UYVY:
+			case SDL_PIXELFORMAT_YVYU:
+				return (width + 1) / 2 * 4 * height;
+			default:
+				return static_cast<std::uint64_t>(SDL_BYTESPERPIXEL(format)) * width * height;
+			}
+		}
+
+		// Surfaces made from caller owned pixels (SDL_PREALLOC) hold no pixel memory of their own.
+		[[nodiscard]] inline std::uint64_t getSurfaceBytes(const SDL_Surface* surface)noexcept
+		{
+			if (surface == nullptr || (surface->flags & SDL_PREALLOC) != 0 || surface->pitch <= 0 || surface->h <= 0)
+			{
+				return 0;
+			}
+			return static_cast<std::uint64_t>(surface->pitch) * static_cast<std::uint64_t>(surface->h);
+		}
+	}
+
+#ifdef SDL2_ENABLE_MEMORY_STATS
+	namespace memory
+	{
+		namespace detail
+		{
+			inline constexpr std::size_t RESOURCES = 2;
+
+			struct Tag
+			{
+				std::string name;
+				std::array<MemoryUsage, RESOURCES> usage{};
+			};
+
+			struct Budget
+			{
+				std::uint64_t bytes = 0;
+				OnBudget onBudget = nullptr;
+				void* userData = nullptr;
+			};
+
+			struct State
+			{
+				std::mutex mutex;
+				// A deque so the names handed out by getTagUsage() never move.
+				std::deque<Tag> tags{ Tag{ "untagged" } };
+				std::array<MemoryUsage, RESOURCES> usage{};
+				std::array<Budget, RESOURCES> budgets{};
+			};
+
+			[[nodiscard]] inline State& getState()noexcept
+			{
+				static State state;
+				return state;
+			}
+
+			[[nodiscard]] inline std::uint16_t& getCurrentTag()noexcept
+			{
+				thread_local std::uint16_t tag = 0;
+				return tag;
+			}
+
+			inline void add(MemoryUsage& usage, std::uint64_t bytes)noexcept
+			{
+				usage.bytes += bytes;
+				usage.peakBytes = std::max(usage.peakBytes, usage.bytes);
+				++usage.count;
+			}
+
+			inline void remove(MemoryUsage& usage, std::uint64_t bytes)noexcept
+			{
+				usage.bytes -= std::min(usage.bytes, bytes);
+				usage.count -= std::min<std::uint64_t>(usage.count, 1);
+			}
+		}
+
+		// Memory counted for one wrapper object. Moves hand the bytes over, destruction gives them back.
+		class Allocation
+		{
+		public:
+			constexpr Allocation()noexcept = default;
+
+			Allocation(const Allocation&) = delete;
+			Allocation& operator=(const Allocation&) = delete;
+
+			Allocation(Allocation&& other)noexcept
+				: m_Bytes(std::exchange(other.m_Bytes, 0))
+				, m_Tag(other.m_Tag)
+				, m_Resource(other.m_Resource)
+			{}
+
+			Allocation& operator=(Allocation&& other)noexcept
+			{
+				if (this != &other)
+				{
+					untrack();
+					m_Bytes = std::exchange(other.m_Bytes, 0);
+					m_Tag = other.m_Tag;
+					m_Resource = other.m_Resource;
+				}
+				return *this;
+			}
+
+			~Allocation() { untrack(); }
+
+			// Counts bytes under the current TagScope of this thread.
+			void track(MemoryResource resource, std::uint64_t bytes)noexcept
+			{
+				untrack();
+				if (bytes == 0)
+				{
+					return;
+				}
+				detail::State& state = detail::getState();
+				const auto index = static_cast<std::size_t>(resource);
+				detail::Budget budget;
+				std::uint64_t total = 0;
+				{
+					std::lock_guard lock{ state.mutex };
+					m_Tag = detail::getCurrentTag();
+					m_Resource = resource;
+					m_Bytes = bytes;
+					const std::uint64_t previous = state.usage[index].bytes;
+					detail::add(state.usage[index], bytes);
+					detail::add(state.tags[m_Tag].usage[index], bytes);
+					total = state.usage[index].bytes;
+					// Only the allocation that crosses the limit reports it.
+					if (state.budgets[index].onBudget != nullptr && previous <= state.budgets[index].bytes && total > state.budgets[index].bytes)
+					{
+						budget = state.budgets[index];
+					}
+				}
+				if (budget.onBudget != nullptr)
+				{
+					budget.onBudget(resource, total, budget.bytes, budget.userData);
+				}
+			}
+
+			void untrack()noexcept
+			{
+				if (m_Bytes == 0)
+				{
+					return;
+				}
+				detail::State& state = detail::getState();
+				const auto index = static_cast<std::size_t>(m_Resource);
+				std::lock_guard lock{ state.mutex };
+				detail::remove(state.usage[index], m_Bytes);
+				detail::remove(state.tags[m_Tag].usage[index], m_Bytes);
+				m_Bytes = 0;
+			}
+
+			[[nodiscard]] std::uint64_t getBytes()const noexcept { return m_Bytes; }
+
+		private:
+			std::uint64_t m_Bytes = 0;
+			std::uint16_t m_Tag = 0;
+			MemoryResource m_Resource = MemoryResource::TEXTURE;
+		};
+
+		// Textures and surfaces created on this thread while it lives are counted under tag.
+		// Up to 65535 distinct tags; further ones fall back to "untagged".
+		class TagScope
+		{
+		public:
+			[[nodiscard]] explicit TagScope(const char* tag)
+				: m_Previous(detail::getCurrentTag())
+			{
+				detail::State& state = detail::getState();
+				std::lock_guard lock{ state.mutex };
+				const auto it = std::find_if(state.tags.begin(), state.tags.end(), [tag](const detail::Tag& entry) { return entry.name == tag; });
+				std::size_t index = static_cast<std::size_t>(it - state.tags.begin());
+				if (it == state.tags.end())
+				{
+					if (state.tags.size() <= 0xFFFF)
+					{
+						state.tags.push_back(detail::Tag{ tag });
+					}
+					else
+					{
+						index = 0;
+					}
+				}
+				detail::getCurrentTag() = static_cast<std::uint16_t>(index);
+			}
+
+			~TagScope() { detail::getCurrentTag() = m_Previous; }
+
+			TagScope(const TagScope&) = delete;
+			TagScope& operator=(const TagScope&) = delete;
+
+		private:
+			std::uint16_t m_Previous;
+		};
+
+		[[nodiscard]] inline MemoryUsage getUsage(MemoryResource resource)
+		{
+			detail::State& state = detail::getState();
+			std::lock_guard lock{ state.mutex };
+			return state.usage[static_cast<std::size_t>(resource)];
+		}
+
+		[[nodiscard]] inline MemoryUsage getUsage(MemoryResource resource, const char* tag)
+		{
+			detail::State& state = detail::getState();
+			std::lock_guard lock{ state.mutex };
+			for (const detail::Tag& entry : state.tags)
+			{
+				if (entry.name == tag)
+				{
+					return entry.usage[static_cast<std::size_t>(resource)];
+				}
+			}
+			return MemoryUsage{};
+		}
+
+		// Every tag seen so far; the names stay valid for the lifetime of the program.
+		[[nodiscard]] inline std::vector<MemoryTagUsage> getTagUsage(MemoryResource resource)
+		{
+			detail::State& state = detail::getState();
+			std::lock_guard lock{ state.mutex };
+			std::vector<MemoryTagUsage> result;
+			result.reserve(state.tags.size());
+			for (const detail::Tag& entry : state.tags)
+			{
+				result.push_back(MemoryTagUsage{ entry.name.c_str(), entry.usage[static_cast<std::size_t>(resource)] });
+			}
+			return result;
+		}
+
+		// Starts the high-water marks over from the current live bytes.
+		inline void resetPeaks()
+		{
+			detail::State& state = detail::getState();
+			std::lock_guard lock{ state.mutex };
+			for (MemoryUsage& usage : state.usage)
+			{
+				usage.peakBytes = usage.bytes;
+			}
+			for (detail::Tag& entry : state.tags)
+			{
+				for (MemoryUsage& usage : entry.usage)
+				{
+					usage.peakBytes = usage.bytes;
+				}
+			}
+		}
+
+		// onBudget fires each time the live bytes go from at most bytes to above it; nullptr clears it.
+		inline void setBudget(MemoryResource resource, std::uint64_t bytes, OnBudget onBudget, void* userData = nullptr)
+		{
+			detail::State& state = detail::getState();
+			std::lock_guard lock{ state.mutex };
+			state.budgets[static_cast<std::size_t>(resource)] = detail::Budget{ bytes, onBudget, userData };
+		}
+	}
+#else
+	namespace memory
+	{
+		class TagScope
+		{
+		public:
+			[[nodiscard]] explicit TagScope(const char*)noexcept {}
+		};
+
+		[[nodiscard]] inline MemoryUsage getUsage(MemoryResource)noexcept { return MemoryUsage{}; }
+
+		[[nodiscard]] inline MemoryUsage getUsage(MemoryResource, const char*)noexcept { return MemoryUsage{}; }
+
+		[[nodiscard]] inline std::vector<MemoryTagUsage> getTagUsage(MemoryResource) { return {}; }
+
+		inline void resetPeaks()noexcept {}
+
+		inline void setBudget(MemoryResource, std::uint64_t, OnBudget, void* = nullptr)noexcept {}
+	}
+#endif
+}
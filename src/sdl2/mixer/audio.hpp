@@ -1,5 +1,6 @@
 #pragma once
 
+#include <SDL_audio.h>
 #include <SDL_mixer.h>
 #include <utility>
 #include <cstdint>
@@ -10,9 +11,96 @@ namespace sdl2::mixer
 {
 	using OnMixingPerformed = void (*)(void* udata, std::uint8_t* stream, int len);
 
-	inline bool openAudio(int frequency, std::uint16_t format, int channels, int chunkSize) { return Mix_OpenAudio(frequency, format, channels, chunkSize) == 0; }
+	namespace detail
+	{
+		// SDL numbers the devices it has open from 1; at most 16 are open at a time.
+		constexpr SDL_AudioDeviceID MAX_DEVICE = 16;
 
-	inline bool openDevice(int frequency, std::uint16_t format, int channels, int chunkSize, const char* device, int allowedchanges) { return Mix_OpenAudioDevice(frequency, format, channels, chunkSize, device, allowedchanges) > 0; }
+		[[nodiscard]] inline SDL_AudioDeviceID& getDevice()noexcept
+		{
+			static SDL_AudioDeviceID device = 0;
+			return device;
+		}
+
+		[[nodiscard]] inline std::uint32_t getOpenDevices()noexcept
+		{
+			std::uint32_t devices = 0;
+			for (SDL_AudioDeviceID id = 1; id <= MAX_DEVICE; ++id)
+			{
+				if (SDL_GetAudioDeviceStatus(id) != SDL_AUDIO_STOPPED)
+				{
+					devices |= std::uint32_t{ 1 } << id;
+				}
+			}
+			return devices;
+		}
+
+		// SDL_mixer does not report the device it opens, so it is the one that was not open before.
+		inline void findDevice(std::uint32_t before)noexcept
+		{
+			const std::uint32_t opened = getOpenDevices() & ~before;
+			for (SDL_AudioDeviceID id = 1; id <= MAX_DEVICE && opened != 0; ++id)
+			{
+				if ((opened & (std::uint32_t{ 1 } << id)) != 0)
+				{
+					getDevice() = id;
+					return;
+				}
+			}
+		}
+	}
+
+	inline bool openAudio(int frequency, std::uint16_t format, int channels, int chunkSize)
+	{
+		const std::uint32_t before = detail::getOpenDevices();
+		const bool isOpen = Mix_OpenAudio(frequency, format, channels, chunkSize) == 0;
+		detail::findDevice(before);
+		return isOpen;
+	}
+
+	inline bool openDevice(int frequency, std::uint16_t format, int channels, int chunkSize, const char* device, int allowedchanges)
+	{
+		const std::uint32_t before = detail::getOpenDevices();
+		const bool isOpen = Mix_OpenAudioDevice(frequency, format, channels, chunkSize, device, allowedchanges) > 0;
+		detail::findDevice(before);
+		return isOpen;
+	}
+
+	// Audio device opened by openAudio() or openDevice(), 0 before. SDL_mixer 2.0.2 and later
+	// open it with SDL_OpenAudioDevice, so SDL_LockAudio() and SDL_PauseAudio(), which only
+	// reach the legacy device 1, do not affect the mixer. A mixer opened by calling SDL_mixer
+	// directly is not known here, and lockAudio() and pauseAudio() then do nothing.
+	[[nodiscard]] inline SDL_AudioDeviceID getDevice()noexcept { return detail::getDevice(); }
+
+	// Keeps the mixer callback from running; recursive and also held while post-mix hooks and
+	// channel effects run.
+	inline void lockAudio()noexcept
+	{
+		if (const SDL_AudioDeviceID device = getDevice(); device != 0)
+		{
+			SDL_LockAudioDevice(device);
+		}
+	}
+
+	inline void unlockAudio()noexcept
+	{
+		if (const SDL_AudioDeviceID device = getDevice(); device != 0)
+		{
+			SDL_UnlockAudioDevice(device);
+		}
+	}
+
+	inline void pauseAudio(bool pause)noexcept
+	{
+#if SDL_MIXER_VERSION_ATLEAST(2, 8, 0)
+		Mix_PauseAudio(pause ? 1 : 0);
+#else
+		if (const SDL_AudioDeviceID device = getDevice(); device != 0)
+		{
+			SDL_PauseAudioDevice(device, pause ? 1 : 0);
+		}
+#endif
+	}
 
 	inline int allocateChannels(int channelsNumber) { return Mix_AllocateChannels(channelsNumber); }
 
@@ -32,6 +120,14 @@ namespace sdl2::mixer
 
 	inline int eachSoundFont(OnSoundFont cb, void* data) { return Mix_EachSoundFont(cb, data); };
 
-	inline void closeAudio() { Mix_CloseAudio(); }
+	inline void closeAudio()
+	{
+		Mix_CloseAudio();
+		// Opening is reference counted; the device only goes away with the last close.
+		if (getDevice() != 0 && SDL_GetAudioDeviceStatus(getDevice()) == SDL_AUDIO_STOPPED)
+		{
+			detail::getDevice() = 0;
+		}
+	}
 
 }
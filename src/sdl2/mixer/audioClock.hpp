@@ -0,0 +1,226 @@
+#pragma once
+
+#include "../spscQueue.hpp"
+#include "audio.hpp"
+#include "channel.hpp"
+#include "postMix.hpp"
+#include "sound.hpp"
+
+#include <SDL_audio.h>
+#include <SDL_mixer.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace sdl2::mixer
+{
+	// Sample clock driven by the post-mix hook.
+	// The audio thread publishes the number of mixed frames together with a performance counter
+	// stamp; any thread can read an interpolated, monotonic playback position without locking.
+	// Latency is estimated as the device buffer (the chunk size passed to openAudio) plus an
+	// optional extra amount for the driver.
+	class AudioClock
+	{
+	public:
+		[[nodiscard]] explicit AudioClock(int chunkSize, std::size_t scheduleCapacity = 256)
+			: m_ChunkSize(std::max(chunkSize, 1))
+			, m_Incoming(scheduleCapacity)
+		{
+			m_Scheduled.reserve(scheduleCapacity);
+		}
+
+		AudioClock(const AudioClock&) = delete;
+		AudioClock& operator=(const AudioClock&) = delete;
+
+		~AudioClock()noexcept { detach(); }
+
+		bool attach()
+		{
+			detach();
+			std::uint16_t format = 0;
+			if (!sdl2::mixer::querySpec(m_Frequency, format, m_Channels) || m_Channels <= 0)
+			{
+				return false;
+			}
+			m_FrameBytes = m_Channels * (SDL_AUDIO_BITSIZE(format) / 8);
+			m_CounterFrequency = SDL_GetPerformanceFrequency();
+			m_Attached = PostMixDispatcher::add(&AudioClock::onPostMix, this, PostMixStage::CLOCK);
+			return m_Attached;
+		}
+
+		void detach()noexcept
+		{
+			if (m_Attached)
+			{
+				PostMixDispatcher::remove(&AudioClock::onPostMix, this);
+				m_Attached = false;
+			}
+		}
+
+		void setExtraLatency(std::chrono::microseconds latency)noexcept { m_ExtraLatency.store(latency.count(), std::memory_order_relaxed); }
+
+		[[nodiscard]] std::int64_t getLatencyFrames()const noexcept
+		{
+			const auto extra = m_ExtraLatency.load(std::memory_order_relaxed) * m_Frequency / 1000000;
+			return m_ChunkSize + extra;
+		}
+
+		[[nodiscard]] int getFrequency()const noexcept { return m_Frequency; }
+
+		// Frames handed to the device so far.
+		[[nodiscard]] std::int64_t getMixedFrames()const noexcept { return m_MixedFrames.load(std::memory_order_acquire); }
+
+		// Estimated frame currently leaving the speakers. Never goes backwards and never
+		// extrapolates past the data that has actually been mixed.
+		[[nodiscard]] std::int64_t getPosition()const noexcept
+		{
+			std::int64_t frames = 0;
+			std::uint64_t stamp = 0;
+			std::int64_t last = 0;
+			std::uint32_t before = 0;
+			do
+			{
+				before = m_Sequence.load(std::memory_order_acquire);
+				frames = m_StampFrames.load(std::memory_order_relaxed);
+				stamp = m_Stamp.load(std::memory_order_relaxed);
+				last = m_LastBlock.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+			} while ((before & 1u) != 0 || before != m_Sequence.load(std::memory_order_relaxed));
+
+			if (stamp == 0 || m_CounterFrequency == 0)
+			{
+				return 0;
+			}
+			const auto elapsed = SDL_GetPerformanceCounter() - stamp;
+			const auto advanced = static_cast<std::int64_t>(static_cast<double>(elapsed) * m_Frequency / static_cast<double>(m_CounterFrequency));
+			const std::int64_t estimate = std::max<std::int64_t>(frames - last + std::min(advanced, last) - getLatencyFrames(), 0);
+
+			std::int64_t reported = m_Reported.load(std::memory_order_relaxed);
+			while (estimate > reported && !m_Reported.compare_exchange_weak(reported, estimate, std::memory_order_relaxed))
+			{
+			}
+			return std::max(estimate, reported);
+		}
+
+		[[nodiscard]] std::chrono::microseconds getTime()const noexcept
+		{
+			return m_Frequency > 0 ? std::chrono::microseconds{ getPosition() * 1000000 / m_Frequency } : std::chrono::microseconds{ 0 };
+		}
+
+		[[nodiscard]] std::int64_t toFrames(std::chrono::microseconds time)const noexcept { return time.count() * m_Frequency / 1000000; }
+
+		// Starts the sound when playback reaches the given frame of the timeline.
+		// SDL_mixer can only start a chunk at a callback boundary, so the start is rounded to the
+		// nearest callback; getScheduleError() reports the accumulated error in frames.
+		bool schedule(sdl2::mixer::Sound& sound, std::int64_t frame, int loops = 0, sdl2::mixer::Channel channel = sdl2::mixer::Channel::Any())
+		{
+			if (!sound.isValid())
+			{
+				return false;
+			}
+			return m_Incoming.push(Scheduled{ sound.get(), frame, loops, channel.get() });
+		}
+
+		bool scheduleIn(sdl2::mixer::Sound& sound, std::chrono::microseconds delay, int loops = 0, sdl2::mixer::Channel channel = sdl2::mixer::Channel::Any())
+		{
+			return schedule(sound, getPosition() + toFrames(delay), loops, channel);
+		}
+
+		[[nodiscard]] std::uint64_t getStartedCount()const noexcept { return m_Started.load(std::memory_order_relaxed); }
+
+		[[nodiscard]] std::uint64_t getDroppedCount()const noexcept { return m_Dropped.load(std::memory_order_relaxed); }
+
+		[[nodiscard]] std::int64_t getScheduleError()const noexcept { return m_ScheduleError.load(std::memory_order_relaxed); }
+
+	private:
+		struct Scheduled
+		{
+			Mix_Chunk* chunk = nullptr;
+			std::int64_t frame = 0;
+			int loops = 0;
+			int channel = -1;
+		};
+
+		void onMixed(int len)noexcept
+		{
+			const std::int64_t block = m_FrameBytes > 0 ? len / m_FrameBytes : 0;
+			const std::int64_t mixed = m_MixedFrames.load(std::memory_order_relaxed) + block;
+
+			const std::uint32_t sequence = m_Sequence.load(std::memory_order_relaxed);
+			m_Sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			m_StampFrames.store(mixed, std::memory_order_relaxed);
+			m_LastBlock.store(block, std::memory_order_relaxed);
+			m_Stamp.store(SDL_GetPerformanceCounter(), std::memory_order_relaxed);
+			m_Sequence.store(sequence + 2, std::memory_order_release);
+			m_MixedFrames.store(mixed, std::memory_order_release);
+
+			startDue(mixed, block);
+		}
+
+		// The next callback mixes stream frames [mixed, mixed + block). Scheduled frames are on the
+		// same stream timeline as getPosition(), which already accounts for the latency.
+		void startDue(std::int64_t mixed, std::int64_t block)noexcept
+		{
+			Scheduled incoming;
+			while (m_Incoming.pop(incoming))
+			{
+				if (m_Scheduled.size() == m_Scheduled.capacity())
+				{
+					m_Dropped.fetch_add(1, std::memory_order_relaxed);
+					continue;
+				}
+				m_Scheduled.push_back(incoming);
+			}
+
+			for (std::size_t i = 0; i < m_Scheduled.size();)
+			{
+				const Scheduled& item = m_Scheduled[i];
+				if (item.frame >= mixed + block / 2)
+				{
+					++i;
+					continue;
+				}
+				if (Mix_PlayChannel(item.channel, item.chunk, item.loops) >= 0)
+				{
+					m_Started.fetch_add(1, std::memory_order_relaxed);
+					const auto error = mixed - item.frame;
+					m_ScheduleError.fetch_add(error < 0 ? -error : error, std::memory_order_relaxed);
+				}
+				else
+				{
+					m_Dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+				m_Scheduled[i] = m_Scheduled.back();
+				m_Scheduled.pop_back();
+			}
+		}
+
+		static void onPostMix(void* udata, std::uint8_t*, int len) { static_cast<AudioClock*>(udata)->onMixed(len); }
+
+		int m_ChunkSize;
+		int m_Frequency = 0;
+		int m_Channels = 0;
+		int m_FrameBytes = 0;
+		std::uint64_t m_CounterFrequency = 0;
+		std::atomic<std::int64_t> m_ExtraLatency{ 0 };
+
+		std::atomic<std::uint32_t> m_Sequence{ 0 };
+		std::atomic<std::int64_t> m_StampFrames{ 0 };
+		std::atomic<std::int64_t> m_LastBlock{ 0 };
+		std::atomic<std::uint64_t> m_Stamp{ 0 };
+		std::atomic<std::int64_t> m_MixedFrames{ 0 };
+		mutable std::atomic<std::int64_t> m_Reported{ 0 };
+
+		sdl2::SpscQueue<Scheduled> m_Incoming;
+		std::vector<Scheduled> m_Scheduled;
+		std::atomic<std::uint64_t> m_Started{ 0 };
+		std::atomic<std::uint64_t> m_Dropped{ 0 };
+		std::atomic<std::int64_t> m_ScheduleError{ 0 };
+
+		bool m_Attached = false;
+	};
+}
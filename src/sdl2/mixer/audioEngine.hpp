@@ -0,0 +1,523 @@
+#pragma once
+
+#include "../spscQueue.hpp"
+#include "audio.hpp"
+#include "dsp.hpp"
+#include "music.hpp"
+#include "sound.hpp"
+
+#include <SDL_audio.h>
+#include <SDL_mixer.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace sdl2::mixer
+{
+	struct VoiceHandle
+	{
+		std::uint32_t slot = INVALID;
+		std::uint32_t generation = 0;
+
+		static constexpr std::uint32_t INVALID = 0xFFFFFFFFu;
+
+		[[nodiscard]] constexpr bool isValid()const noexcept { return slot != INVALID; }
+	};
+
+	struct VoiceParams
+	{
+		float gain = 1.0f;
+		float pan = 0.0f;
+		float pitch = 1.0f;
+		int loops = 0;
+	};
+
+	// Software mixer for large numbers of short voices.
+	// It either opens its own device (SDL_OpenAudioDevice) or renders into the
+	// SDL_mixer music slot (Mix_HookMusic), so regular channels keep working on top.
+	// Source chunks must be in the engine source format (the mixer format when hooked),
+	// interleaved with the same channel count as the output. Voices read the chunk memory
+	// directly: call stopSound() before freeing or reloading a chunk that may still be playing.
+	// The game thread talks to the audio thread only through lock-free queues.
+	class AudioEngine
+	{
+	public:
+		[[nodiscard]] explicit AudioEngine(std::size_t maxVoices = 512, std::size_t commandCapacity = 4096, int maxFramesPerBlock = 1024)
+			: m_Commands(commandCapacity)
+			, m_Released(maxVoices)
+			, m_Voices(maxVoices)
+			, m_Generations(maxVoices, 0)
+			, m_MaxFrames(std::max(maxFramesPerBlock, 1))
+		{
+			m_Active.reserve(maxVoices);
+			m_FreeSlots.reserve(maxVoices);
+			for (std::size_t i = maxVoices; i > 0; --i)
+			{
+				m_FreeSlots.push_back(static_cast<std::uint32_t>(i - 1));
+			}
+		}
+
+		AudioEngine(const AudioEngine&) = delete;
+		AudioEngine& operator=(const AudioEngine&) = delete;
+
+		~AudioEngine()noexcept { close(); }
+
+		bool openDevice(int frequency = 48000, int channels = 2, std::uint16_t sourceFormat = AUDIO_S16SYS, std::uint16_t samples = 512, const char* device = nullptr)
+		{
+			close();
+			if (!dsp::isSupported(sourceFormat) || channels <= 0 || channels > MAX_CHANNELS)
+			{
+				return false;
+			}
+			SDL_AudioSpec want{};
+			want.freq = frequency;
+			want.format = AUDIO_F32SYS;
+			want.channels = static_cast<std::uint8_t>(channels);
+			want.samples = samples;
+			want.callback = &AudioEngine::onDevice;
+			want.userdata = this;
+			SDL_AudioSpec have{};
+			m_Device = SDL_OpenAudioDevice(device, 0, &want, &have, 0);
+			if (m_Device == 0)
+			{
+				return false;
+			}
+			configure(have.freq, AUDIO_F32SYS, have.channels, sourceFormat);
+			SDL_PauseAudioDevice(m_Device, 0);
+			return true;
+		}
+
+		bool hookMusic()
+		{
+			close();
+			int frequency = 0;
+			std::uint16_t format = 0;
+			int channels = 0;
+			if (!sdl2::mixer::querySpec(frequency, format, channels) || !dsp::isSupported(format) || channels > MAX_CHANNELS)
+			{
+				return false;
+			}
+			configure(frequency, format, channels, format);
+			sdl2::mixer::Music::hook(&AudioEngine::onMusicHook, this);
+			m_Hooked = true;
+			return true;
+		}
+
+		// Stops every voice; their slots are free again after the next reclaim().
+		void close()noexcept
+		{
+			if (m_Device != 0)
+			{
+				SDL_CloseAudioDevice(m_Device);
+				m_Device = 0;
+			}
+			if (m_Hooked)
+			{
+				sdl2::mixer::Music::hook(nullptr, nullptr);
+				m_Hooked = false;
+			}
+			// The callback no longer runs, so this thread may take over the audio side.
+			stopVoices(nullptr);
+		}
+
+		[[nodiscard]] bool isOpen()const noexcept { return m_Device != 0 || m_Hooked; }
+
+		VoiceHandle play(const sdl2::mixer::Sound& sound, const VoiceParams& params = {}) { return play(sound.get(), params); }
+
+		VoiceHandle play(const Mix_Chunk* chunk, const VoiceParams& params = {})
+		{
+			reclaim();
+			if (chunk == nullptr || m_FrameBytes == 0 || m_FreeSlots.empty())
+			{
+				m_Dropped.fetch_add(1, std::memory_order_relaxed);
+				return {};
+			}
+			const std::uint32_t slot = m_FreeSlots.back();
+			const std::uint32_t generation = ++m_Generations[slot];
+
+			Command command;
+			command.type = CommandType::PLAY;
+			command.slot = slot;
+			command.generation = generation;
+			command.data = chunk->abuf;
+			command.frames = chunk->alen / m_FrameBytes;
+			command.params = params;
+			if (!m_Commands.push(command))
+			{
+				m_Dropped.fetch_add(1, std::memory_order_relaxed);
+				return {};
+			}
+			m_FreeSlots.pop_back();
+			return VoiceHandle{ slot, generation };
+		}
+
+		bool stop(VoiceHandle voice) { return send(CommandType::STOP, voice, {}); }
+
+		void stopSound(const sdl2::mixer::Sound& sound)noexcept { stopSound(sound.get()); }
+
+		// Stops the voices playing chunk, including ones still queued, and returns once the audio
+		// thread no longer reads it, so the chunk can be freed right after.
+		void stopSound(const Mix_Chunk* chunk)noexcept
+		{
+			if (chunk == nullptr)
+			{
+				return;
+			}
+			lock();
+			stopVoices(chunk->abuf);
+			unlock();
+		}
+
+		bool setParams(VoiceHandle voice, const VoiceParams& params) { return send(CommandType::SET_PARAMS, voice, params); }
+
+		bool stopAll()
+		{
+			Command command;
+			command.type = CommandType::STOP_ALL;
+			return m_Commands.push(command);
+		}
+
+		void setMasterGain(float gain)noexcept { m_MasterGain.store(gain, std::memory_order_relaxed); }
+
+		// Returns slots of finished voices to the game thread. play() calls it too.
+		void reclaim()
+		{
+			std::uint32_t slot;
+			while (m_Released.pop(slot))
+			{
+				m_FreeSlots.push_back(slot);
+			}
+		}
+
+		[[nodiscard]] std::size_t getActiveVoicesCount()const noexcept { return m_ActiveCount.load(std::memory_order_relaxed); }
+
+		[[nodiscard]] std::uint64_t getDroppedCount()const noexcept { return m_Dropped.load(std::memory_order_relaxed); }
+
+		[[nodiscard]] std::size_t getMaxVoices()const noexcept { return m_Voices.size(); }
+
+		[[nodiscard]] int getFrequency()const noexcept { return m_Frequency; }
+
+		[[nodiscard]] int getChannels()const noexcept { return m_Channels; }
+
+		// Renders frames * channels samples; called from the audio callback, usable directly for offline rendering.
+		void render(float* output, int frames)noexcept
+		{
+			drainCommands();
+			const auto channels = static_cast<std::size_t>(m_Channels);
+			dsp::clear(output, static_cast<std::size_t>(frames) * channels);
+			for (int offset = 0; offset < frames; offset += m_MaxFrames)
+			{
+				const int block = std::min(frames - offset, m_MaxFrames);
+				float* out = output + static_cast<std::size_t>(offset) * channels;
+				for (std::size_t i = 0; i < m_Active.size();)
+				{
+					if (renderVoice(m_Voices[m_Active[i]], out, block))
+					{
+						++i;
+						continue;
+					}
+					m_Voices[m_Active[i]].active = false;
+					m_Released.push(m_Active[i]);
+					m_Active[i] = m_Active.back();
+					m_Active.pop_back();
+				}
+			}
+			dsp::applyGain(output, static_cast<std::size_t>(frames) * channels, m_MasterGain.load(std::memory_order_relaxed));
+			m_ActiveCount.store(m_Active.size(), std::memory_order_relaxed);
+		}
+
+	private:
+		static constexpr int MAX_CHANNELS = 8;
+		static constexpr int FRACTION_BITS = 32;
+		static constexpr std::uint64_t ONE = std::uint64_t{ 1 } << FRACTION_BITS;
+
+		enum class CommandType : std::uint8_t
+		{
+			PLAY,
+			STOP,
+			SET_PARAMS,
+			STOP_ALL
+		};
+
+		struct Command
+		{
+			CommandType type = CommandType::STOP;
+			std::uint32_t slot = 0;
+			std::uint32_t generation = 0;
+			const void* data = nullptr;
+			std::uint32_t frames = 0;
+			VoiceParams params;
+		};
+
+		struct Voice
+		{
+			bool active = false;
+			std::uint32_t generation = 0;
+			const void* data = nullptr;
+			std::uint32_t frames = 0;
+			std::uint64_t position = 0;
+			std::uint64_t step = ONE;
+			int loops = 0;
+			std::array<float, MAX_CHANNELS> gains{};
+		};
+
+		// Holds the audio callback off, so the calling thread may run the audio side meanwhile.
+		void lock()noexcept
+		{
+			if (m_Device != 0)
+			{
+				SDL_LockAudioDevice(m_Device);
+			}
+			else if (m_Hooked)
+			{
+				sdl2::mixer::lockAudio();
+			}
+		}
+
+		void unlock()noexcept
+		{
+			if (m_Device != 0)
+			{
+				SDL_UnlockAudioDevice(m_Device);
+			}
+			else if (m_Hooked)
+			{
+				sdl2::mixer::unlockAudio();
+			}
+		}
+
+		// Audio side: applies the queued commands, then stops the voices reading data, or all of
+		// them for nullptr.
+		void stopVoices(const void* data)noexcept
+		{
+			drainCommands();
+			for (std::size_t i = 0; i < m_Active.size();)
+			{
+				Voice& voice = m_Voices[m_Active[i]];
+				if (data != nullptr && voice.data != data)
+				{
+					++i;
+					continue;
+				}
+				voice.active = false;
+				m_Released.push(m_Active[i]);
+				m_Active[i] = m_Active.back();
+				m_Active.pop_back();
+			}
+			m_ActiveCount.store(m_Active.size(), std::memory_order_relaxed);
+		}
+
+		void configure(int frequency, std::uint16_t outputFormat, int channels, std::uint16_t sourceFormat)
+		{
+			m_Frequency = frequency;
+			m_OutputFormat = outputFormat;
+			m_SourceFormat = sourceFormat;
+			m_Channels = channels;
+			m_FrameBytes = static_cast<std::uint32_t>(channels) * (sourceFormat == AUDIO_F32SYS ? 4u : 2u);
+			m_Mix.assign(static_cast<std::size_t>(m_MaxFrames * channels), 0.0f);
+			m_Scratch.assign(static_cast<std::size_t>(m_MaxFrames * channels), 0.0f);
+		}
+
+		bool send(CommandType type, VoiceHandle voice, const VoiceParams& params)
+		{
+			if (!voice.isValid() || voice.slot >= m_Voices.size())
+			{
+				return false;
+			}
+			Command command;
+			command.type = type;
+			command.slot = voice.slot;
+			command.generation = voice.generation;
+			command.params = params;
+			return m_Commands.push(command);
+		}
+
+		void applyParams(Voice& voice, const VoiceParams& params)noexcept
+		{
+			const float gain = std::max(params.gain, 0.0f);
+			const float pan = std::clamp(params.pan, -1.0f, 1.0f);
+			voice.gains.fill(gain);
+			if (m_Channels == 2)
+			{
+				voice.gains[0] = gain * std::min(1.0f, 1.0f - pan);
+				voice.gains[1] = gain * std::min(1.0f, 1.0f + pan);
+			}
+			voice.step = static_cast<std::uint64_t>(static_cast<double>(std::max(params.pitch, 0.0f)) * static_cast<double>(ONE));
+			voice.loops = params.loops;
+		}
+
+		void drainCommands()noexcept
+		{
+			Command command;
+			while (m_Commands.pop(command))
+			{
+				if (command.type == CommandType::STOP_ALL)
+				{
+					for (const std::uint32_t slot : m_Active)
+					{
+						m_Voices[slot].active = false;
+						m_Released.push(slot);
+					}
+					m_Active.clear();
+					continue;
+				}
+				Voice& voice = m_Voices[command.slot];
+				if (command.type == CommandType::PLAY)
+				{
+					voice.active = true;
+					voice.generation = command.generation;
+					voice.data = command.data;
+					voice.frames = command.frames;
+					voice.position = 0;
+					applyParams(voice, command.params);
+					m_Active.push_back(command.slot);
+					continue;
+				}
+				if (!voice.active || voice.generation != command.generation)
+				{
+					continue;
+				}
+				if (command.type == CommandType::SET_PARAMS)
+				{
+					applyParams(voice, command.params);
+				}
+				else
+				{
+					voice.active = false;
+					const auto it = std::find(m_Active.begin(), m_Active.end(), command.slot);
+					if (it != m_Active.end())
+					{
+						*it = m_Active.back();
+						m_Active.pop_back();
+					}
+					m_Released.push(command.slot);
+				}
+			}
+		}
+
+		[[nodiscard]] float sampleAt(const Voice& voice, std::size_t index)const noexcept
+		{
+			if (m_SourceFormat == AUDIO_F32SYS)
+			{
+				return static_cast<const float*>(voice.data)[index];
+			}
+			return static_cast<float>(static_cast<const std::int16_t*>(voice.data)[index]) * dsp::S16_SCALE;
+		}
+
+		// Mixes one block of the voice into out. Returns false once the voice has finished.
+		bool renderVoice(Voice& voice, float* out, int frames)noexcept
+		{
+			if (!voice.active)
+			{
+				return false;
+			}
+			const auto channels = static_cast<std::size_t>(m_Channels);
+			const std::uint64_t length = std::uint64_t{ voice.frames } << FRACTION_BITS;
+			int done = 0;
+			while (done < frames)
+			{
+				if (voice.position >= length || voice.frames == 0)
+				{
+					if (voice.loops == 0 || voice.frames == 0)
+					{
+						return false;
+					}
+					if (voice.loops > 0)
+					{
+						--voice.loops;
+					}
+					voice.position -= length;
+				}
+				// Below voice.frames, so it fits in 32 bits.
+				const auto frame = static_cast<std::uint32_t>(voice.position >> FRACTION_BITS);
+				float* destination = out + static_cast<std::size_t>(done) * channels;
+
+				if (voice.step == ONE && (voice.position & (ONE - 1)) == 0)
+				{
+					const auto count = std::min<std::size_t>(static_cast<std::size_t>(frames - done), voice.frames - frame);
+					const float* source = m_Scratch.data();
+					if (m_SourceFormat == AUDIO_F32SYS)
+					{
+						source = static_cast<const float*>(voice.data) + frame * channels;
+					}
+					else
+					{
+						dsp::toFloat(static_cast<const std::int16_t*>(voice.data) + frame * channels, m_Scratch.data(), count * channels);
+					}
+					dsp::accumulateInterleaved(destination, source, count, channels, voice.gains.data());
+					voice.position += static_cast<std::uint64_t>(count) << FRACTION_BITS;
+					done += static_cast<int>(count);
+					continue;
+				}
+
+				for (; done < frames && voice.position < length; ++done, voice.position += voice.step)
+				{
+					const auto index = static_cast<std::uint32_t>(voice.position >> FRACTION_BITS);
+					// A looping voice interpolates its last frame towards the first one.
+					std::uint32_t next = index + 1;
+					if (next >= voice.frames)
+					{
+						next = voice.loops != 0 ? 0 : index;
+					}
+					const float t = static_cast<float>(voice.position & (ONE - 1)) / static_cast<float>(ONE);
+					float* target = out + static_cast<std::size_t>(done) * channels;
+					for (std::size_t c = 0; c < channels; ++c)
+					{
+						const float a = sampleAt(voice, std::size_t{ index } * channels + c);
+						const float b = sampleAt(voice, std::size_t{ next } * channels + c);
+						target[c] += (a + (b - a) * t) * voice.gains[c];
+					}
+				}
+			}
+			return true;
+		}
+
+		void renderTo(std::uint8_t* stream, int len)noexcept
+		{
+			const int sampleBytes = m_OutputFormat == AUDIO_F32SYS ? 4 : 2;
+			int frames = len / (sampleBytes * m_Channels);
+			while (frames > 0)
+			{
+				const int block = std::min(frames, m_MaxFrames);
+				const auto count = static_cast<std::size_t>(block * m_Channels);
+				render(m_Mix.data(), block);
+				if (m_OutputFormat == AUDIO_F32SYS)
+				{
+					std::copy(m_Mix.data(), m_Mix.data() + count, reinterpret_cast<float*>(stream));
+				}
+				else
+				{
+					dsp::fromFloat(m_Mix.data(), reinterpret_cast<std::int16_t*>(stream), count);
+				}
+				stream += count * static_cast<std::size_t>(sampleBytes);
+				frames -= block;
+			}
+		}
+
+		static void onDevice(void* udata, std::uint8_t* stream, int len) { static_cast<AudioEngine*>(udata)->renderTo(stream, len); }
+
+		static void onMusicHook(void* udata, std::uint8_t* stream, int len) { static_cast<AudioEngine*>(udata)->renderTo(stream, len); }
+
+		sdl2::SpscQueue<Command> m_Commands;
+		sdl2::SpscQueue<std::uint32_t> m_Released;
+		std::vector<Voice> m_Voices;
+		std::vector<std::uint32_t> m_Generations;
+		std::vector<std::uint32_t> m_FreeSlots;
+		std::vector<std::uint32_t> m_Active;
+		std::vector<float> m_Mix;
+		std::vector<float> m_Scratch;
+		std::atomic<float> m_MasterGain{ 1.0f };
+		std::atomic<std::size_t> m_ActiveCount{ 0 };
+		std::atomic<std::uint64_t> m_Dropped{ 0 };
+		SDL_AudioDeviceID m_Device = 0;
+		bool m_Hooked = false;
+		int m_MaxFrames;
+		int m_Frequency = 0;
+		int m_Channels = 0;
+		std::uint16_t m_OutputFormat = 0;
+		std::uint16_t m_SourceFormat = 0;
+		std::uint32_t m_FrameBytes = 0;
+	};
+}
@@ -29,12 +29,14 @@ namespace sdl2::mixer
 
 		[[nodiscard]] int count() noexcept { return Mix_GroupCount(m_Tag); }
 
-		[[nodiscard]] int findOldestSample(int tag) noexcept { return Mix_GroupOldest(m_Tag); }
+		[[nodiscard]] int findOldestSample() noexcept { return Mix_GroupOldest(m_Tag); }
 
-		[[nodiscard]] int findYoungestSample(int tag) noexcept { return Mix_GroupNewer(m_Tag); }
+		[[nodiscard]] int findYoungestSample() noexcept { return Mix_GroupNewer(m_Tag); }
 
 		int fadeOut(std::chrono::milliseconds ms) noexcept { return Mix_FadeOutGroup(m_Tag, ms.count()); }
 
+		[[nodiscard]] constexpr int get()const noexcept { return m_Tag; }
+
 	protected:
 		int m_Tag;
 	};
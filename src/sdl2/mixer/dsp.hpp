@@ -0,0 +1,190 @@
+#pragma once
+
+#include <SDL_audio.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define SDL2_MIXER_DSP_SSE2
+#endif
+
+// Block kernels shared by the effect chain and the software mixer.
+// All of them work in place or on caller owned buffers and never allocate.
+namespace sdl2::mixer::dsp
+{
+	constexpr float S16_SCALE = 1.0f / 32768.0f;
+
+	inline void toFloat(const std::int16_t* source, float* destination, std::size_t count)noexcept
+	{
+		std::size_t i = 0;
+#ifdef SDL2_MIXER_DSP_SSE2
+		const __m128 scale = _mm_set1_ps(S16_SCALE);
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+			const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+			_mm_storeu_ps(destination + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+			_mm_storeu_ps(destination + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			destination[i] = static_cast<float>(source[i]) * S16_SCALE;
+		}
+	}
+
+	inline void fromFloat(const float* source, std::int16_t* destination, std::size_t count)noexcept
+	{
+		std::size_t i = 0;
+#ifdef SDL2_MIXER_DSP_SSE2
+		const __m128 scale = _mm_set1_ps(32768.0f);
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(source + i), scale));
+			const __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(source + i + 4), scale));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packs_epi32(lo, hi));
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const float v = std::clamp(source[i] * 32768.0f, -32768.0f, 32767.0f);
+			destination[i] = static_cast<std::int16_t>(std::lrint(v));
+		}
+	}
+
+	inline void clear(float* samples, std::size_t count)noexcept
+	{
+		std::fill(samples, samples + count, 0.0f);
+	}
+
+	inline void applyGain(float* samples, std::size_t count, float gain)noexcept
+	{
+		std::size_t i = 0;
+#ifdef SDL2_MIXER_DSP_SSE2
+		const __m128 g = _mm_set1_ps(gain);
+		for (; i + 4 <= count; i += 4)
+		{
+			_mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), g));
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			samples[i] *= gain;
+		}
+	}
+
+	inline void applyGainRamp(float* samples, std::size_t frames, std::size_t channels, float from, float to)noexcept
+	{
+		if (from == to)
+		{
+			applyGain(samples, frames * channels, to);
+			return;
+		}
+		const float step = frames > 0 ? (to - from) / static_cast<float>(frames) : 0.0f;
+		std::size_t frame = 0;
+#ifdef SDL2_MIXER_DSP_SSE2
+		// With 1, 2 or 4 channels a vector holds whole frames: lane i belongs to frame i / channels.
+		if (channels > 0 && 4 % channels == 0)
+		{
+			const std::size_t framesPerVector = 4 / channels;
+			const auto lane = [&](std::size_t i) { return from + step * static_cast<float>(i / channels); };
+			__m128 gains = _mm_set_ps(lane(3), lane(2), lane(1), lane(0));
+			const __m128 increment = _mm_set1_ps(step * static_cast<float>(framesPerVector));
+			for (; frame + framesPerVector <= frames; frame += framesPerVector)
+			{
+				float* out = samples + frame * channels;
+				_mm_storeu_ps(out, _mm_mul_ps(_mm_loadu_ps(out), gains));
+				gains = _mm_add_ps(gains, increment);
+			}
+		}
+#endif
+		float gain = from + step * static_cast<float>(frame);
+		for (; frame < frames; ++frame, gain += step)
+		{
+			float* out = samples + frame * channels;
+			for (std::size_t c = 0; c < channels; ++c)
+			{
+				out[c] *= gain;
+			}
+		}
+	}
+
+	inline void accumulate(float* destination, const float* source, std::size_t count, float gain)noexcept
+	{
+		std::size_t i = 0;
+#ifdef SDL2_MIXER_DSP_SSE2
+		const __m128 g = _mm_set1_ps(gain);
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 sum = _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(_mm_loadu_ps(source + i), g));
+			_mm_storeu_ps(destination + i, sum);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			destination[i] += source[i] * gain;
+		}
+	}
+
+	inline void accumulateInterleaved(float* destination, const float* source, std::size_t frames, std::size_t channels, const float* gains)noexcept
+	{
+		std::size_t frame = 0;
+#ifdef SDL2_MIXER_DSP_SSE2
+		if (channels == 2)
+		{
+			const __m128 g = _mm_set_ps(gains[1], gains[0], gains[1], gains[0]);
+			for (; frame + 2 <= frames; frame += 2)
+			{
+				const __m128 sum = _mm_add_ps(_mm_loadu_ps(destination + frame * 2), _mm_mul_ps(_mm_loadu_ps(source + frame * 2), g));
+				_mm_storeu_ps(destination + frame * 2, sum);
+			}
+		}
+#endif
+		for (; frame < frames; ++frame)
+		{
+			for (std::size_t c = 0; c < channels; ++c)
+			{
+				destination[frame * channels + c] += source[frame * channels + c] * gains[c];
+			}
+		}
+	}
+
+	[[nodiscard]] inline float peak(const float* samples, std::size_t frames, std::size_t channels, std::size_t channel)noexcept
+	{
+		float result = 0.0f;
+		std::size_t frame = 0;
+#ifdef SDL2_MIXER_DSP_SSE2
+		if (channels > 0 && 4 % channels == 0 && channel < channels)
+		{
+			const std::size_t framesPerVector = 4 / channels;
+			const __m128 signBit = _mm_set1_ps(-0.0f);
+			__m128 peaks = _mm_setzero_ps();
+			for (; frame + framesPerVector <= frames; frame += framesPerVector)
+			{
+				peaks = _mm_max_ps(peaks, _mm_andnot_ps(signBit, _mm_loadu_ps(samples + frame * channels)));
+			}
+			alignas(16) float lanes[4];
+			_mm_store_ps(lanes, peaks);
+			for (std::size_t i = channel; i < 4; i += channels)
+			{
+				result = std::max(result, lanes[i]);
+			}
+		}
+#endif
+		for (; frame < frames; ++frame)
+		{
+			result = std::max(result, std::fabs(samples[frame * channels + channel]));
+		}
+		return result;
+	}
+
+	[[nodiscard]] inline float decibelsToGain(float decibels)noexcept { return std::pow(10.0f, decibels / 20.0f); }
+
+	[[nodiscard]] inline float gainToDecibels(float gain)noexcept { return 20.0f * std::log10(std::max(gain, 1e-9f)); }
+
+	[[nodiscard]] constexpr bool isSupported(std::uint16_t format)noexcept { return format == AUDIO_S16SYS || format == AUDIO_F32SYS; }
+}
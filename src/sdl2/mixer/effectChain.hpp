@@ -0,0 +1,555 @@
+#pragma once
+
+#include "audio.hpp"
+#include "channel.hpp"
+#include "dsp.hpp"
+#include "postMix.hpp"
+
+#include <SDL_assert.h>
+#include <SDL_audio.h>
+#include <SDL_mixer.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace sdl2::mixer
+{
+	// Effects run on the audio thread on interleaved float samples in [-1, 1].
+	// prepare() is called from attach() on the calling thread and is the only
+	// place where an effect may allocate.
+	class Effect
+	{
+	public:
+		virtual ~Effect() = default;
+
+		virtual void prepare(int /*frequency*/, int /*channels*/, int /*maxFrames*/) {}
+
+		virtual void process(float* samples, int frames, int channels)noexcept = 0;
+
+		void setBypassed(bool bypassed)noexcept { m_Bypassed.store(bypassed, std::memory_order_relaxed); }
+
+		[[nodiscard]] bool isBypassed()const noexcept { return m_Bypassed.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<bool> m_Bypassed{ false };
+	};
+
+	class EffectChain
+	{
+	public:
+		static constexpr int POST_MIX = MIX_CHANNEL_POST;
+
+		[[nodiscard]] explicit EffectChain(int maxFramesPerBlock = 1024)noexcept : m_MaxFrames(std::max(maxFramesPerBlock, 1)) {}
+
+		EffectChain(const EffectChain&) = delete;
+		EffectChain& operator=(const EffectChain&) = delete;
+
+		~EffectChain()noexcept { detach(); }
+
+		template<class T, class... Args>
+		T& add(Args&&... args)
+		{
+			SDL_assert(!isAttached());
+			auto effect = std::make_unique<T>(std::forward<Args>(args)...);
+			T& ref = *effect;
+			m_Effects.push_back(std::move(effect));
+			return ref;
+		}
+
+		void clear()
+		{
+			SDL_assert(!isAttached());
+			m_Effects.clear();
+		}
+
+		// A channel takes one chain at a time; attaching a second one fails. SDL_mixer drops the
+		// chain when the channel finishes playing, after which isAttached() is false again.
+		bool attach(const sdl2::mixer::Channel& channel)
+		{
+			if (channel.get() < 0 || !prepare())
+			{
+				return false;
+			}
+			const auto index = static_cast<std::size_t>(channel.get());
+			bool isRegistered = false;
+			sdl2::mixer::lockAudio();
+			std::vector<EffectChain*>& chains = getChannelChains();
+			if (index >= chains.size())
+			{
+				chains.resize(index + 1, nullptr);
+			}
+			if (chains[index] == nullptr && channel.registerEffect(&EffectChain::onChannelEffect, &EffectChain::onChannelDone, this))
+			{
+				chains[index] = this;
+				m_Target.store(channel.get(), std::memory_order_release);
+				isRegistered = true;
+			}
+			sdl2::mixer::unlockAudio();
+			return isRegistered;
+		}
+
+		// Runs the chain on the final mix, in the EFFECTS stage of the PostMixDispatcher.
+		bool attachPostMix()
+		{
+			if (!prepare() || !PostMixDispatcher::add(&EffectChain::onPostMix, this, PostMixStage::EFFECTS))
+			{
+				return false;
+			}
+			m_Target.store(POST_MIX, std::memory_order_release);
+			return true;
+		}
+
+		void detach()noexcept
+		{
+			const int target = m_Target.load(std::memory_order_acquire);
+			if (target == POST_MIX)
+			{
+				PostMixDispatcher::remove(&EffectChain::onPostMix, this);
+				m_Target.store(DETACHED, std::memory_order_release);
+			}
+			else if (target != DETACHED)
+			{
+				// Under the audio lock the channel cannot finish meanwhile, and since it holds no
+				// other chain the first registration of onChannelEffect is this one.
+				sdl2::mixer::lockAudio();
+				if (m_Target.load(std::memory_order_relaxed) != DETACHED)
+				{
+					sdl2::mixer::Channel{ target }.unregisterEffect(&EffectChain::onChannelEffect);
+				}
+				release(target);
+				sdl2::mixer::unlockAudio();
+			}
+		}
+
+		[[nodiscard]] bool isAttached()const noexcept { return m_Target.load(std::memory_order_acquire) != DETACHED; }
+
+		void process(void* stream, int len)noexcept
+		{
+			if (m_Channels <= 0 || len <= 0)
+			{
+				return;
+			}
+			if (m_Format == AUDIO_F32SYS)
+			{
+				const int frames = len / static_cast<int>(sizeof(float)) / m_Channels;
+				run(static_cast<float*>(stream), frames);
+				return;
+			}
+
+			auto* samples = static_cast<std::int16_t*>(stream);
+			int frames = len / static_cast<int>(sizeof(std::int16_t)) / m_Channels;
+			while (frames > 0)
+			{
+				const int block = std::min(frames, m_MaxFrames);
+				const auto count = static_cast<std::size_t>(block * m_Channels);
+				dsp::toFloat(samples, m_Scratch.data(), count);
+				run(m_Scratch.data(), block);
+				dsp::fromFloat(m_Scratch.data(), samples, count);
+				samples += count;
+				frames -= block;
+			}
+		}
+
+		[[nodiscard]] std::size_t size()const noexcept { return m_Effects.size(); }
+
+	private:
+		static constexpr int DETACHED = -3;
+
+		bool prepare()
+		{
+			detach();
+			int frequency = 0;
+			std::uint16_t format = 0;
+			if (!sdl2::mixer::querySpec(frequency, format, m_Channels) || !dsp::isSupported(format))
+			{
+				return false;
+			}
+			m_Format = format;
+			m_Scratch.assign(static_cast<std::size_t>(m_MaxFrames * m_Channels), 0.0f);
+			for (auto& effect : m_Effects)
+			{
+				effect->prepare(frequency, m_Channels, m_MaxFrames);
+			}
+			return true;
+		}
+
+		void run(float* samples, int frames)noexcept
+		{
+			for (int offset = 0; offset < frames; offset += m_MaxFrames)
+			{
+				const int block = std::min(frames - offset, m_MaxFrames);
+				float* data = samples + offset * m_Channels;
+				for (auto& effect : m_Effects)
+				{
+					if (!effect->isBypassed())
+					{
+						effect->process(data, block, m_Channels);
+					}
+				}
+			}
+		}
+
+		static void onPostMix(void* udata, std::uint8_t* stream, int len) { static_cast<EffectChain*>(udata)->process(stream, len); }
+
+		static void onChannelEffect(int, void* stream, int len, void* udata) { static_cast<EffectChain*>(udata)->process(stream, len); }
+
+		// Only one chain per channel is allowed, see attach().
+		[[nodiscard]] static std::vector<EffectChain*>& getChannelChains()
+		{
+			static std::vector<EffectChain*> chains;
+			return chains;
+		}
+
+		// Called with the audio device locked.
+		void release(int channel)noexcept
+		{
+			std::vector<EffectChain*>& chains = getChannelChains();
+			if (channel >= 0 && static_cast<std::size_t>(channel) < chains.size() && chains[static_cast<std::size_t>(channel)] == this)
+			{
+				chains[static_cast<std::size_t>(channel)] = nullptr;
+			}
+			m_Target.store(DETACHED, std::memory_order_release);
+		}
+
+		// SDL_mixer calls it with the device locked when the effect is unregistered or the channel
+		// stops playing.
+		static void onChannelDone(int channel, void* udata) { static_cast<EffectChain*>(udata)->release(channel); }
+
+		std::vector<std::unique_ptr<Effect>> m_Effects;
+		std::vector<float> m_Scratch;
+		int m_MaxFrames;
+		int m_Channels = 0;
+		std::uint16_t m_Format = 0;
+		std::atomic<int> m_Target{ DETACHED };
+	};
+
+	inline bool setPostMix(EffectChain& chain) { return chain.attachPostMix(); }
+
+	namespace effects
+	{
+		constexpr int MAX_CHANNELS = 8;
+
+		class Gain : public Effect
+		{
+		public:
+			[[nodiscard]] explicit Gain(float gain = 1.0f)noexcept : m_Target(gain), m_Current(gain) {}
+
+			void setGain(float gain)noexcept { m_Target.store(gain, std::memory_order_relaxed); }
+
+			void setDecibels(float decibels)noexcept { setGain(dsp::decibelsToGain(decibels)); }
+
+			[[nodiscard]] float getGain()const noexcept { return m_Target.load(std::memory_order_relaxed); }
+
+			void process(float* samples, int frames, int channels)noexcept override
+			{
+				const float target = m_Target.load(std::memory_order_relaxed);
+				dsp::applyGainRamp(samples, static_cast<std::size_t>(frames), static_cast<std::size_t>(channels), m_Current, target);
+				m_Current = target;
+			}
+
+		private:
+			std::atomic<float> m_Target;
+			float m_Current;
+		};
+
+		// RBJ cookbook biquad, transposed direct form II, one state per channel.
+		class Biquad : public Effect
+		{
+		public:
+			enum class Type
+			{
+				LOW_PASS,
+				HIGH_PASS
+			};
+
+			[[nodiscard]] Biquad(Type type, float cutoff, float q = 0.7071f)noexcept : m_Type(type), m_Cutoff(cutoff), m_Q(q) {}
+
+			void setCutoff(float cutoff)noexcept
+			{
+				m_Cutoff.store(cutoff, std::memory_order_relaxed);
+				m_Dirty.store(true, std::memory_order_release);
+			}
+
+			void setQ(float q)noexcept
+			{
+				m_Q.store(q, std::memory_order_relaxed);
+				m_Dirty.store(true, std::memory_order_release);
+			}
+
+			void prepare(int frequency, int, int)override
+			{
+				m_Frequency = static_cast<float>(frequency);
+				m_State = {};
+				updateCoefficients();
+			}
+
+			void process(float* samples, int frames, int channels)noexcept override
+			{
+				if (m_Dirty.exchange(false, std::memory_order_acquire))
+				{
+					updateCoefficients();
+				}
+				const int count = std::min(channels, MAX_CHANNELS);
+				for (int c = 0; c < count; ++c)
+				{
+					float z1 = m_State[static_cast<std::size_t>(c)].z1;
+					float z2 = m_State[static_cast<std::size_t>(c)].z2;
+					for (int frame = 0; frame < frames; ++frame)
+					{
+						float& x = samples[frame * channels + c];
+						const float y = m_B0 * x + z1;
+						z1 = m_B1 * x - m_A1 * y + z2;
+						z2 = m_B2 * x - m_A2 * y;
+						x = y;
+					}
+					m_State[static_cast<std::size_t>(c)] = { z1, z2 };
+				}
+			}
+
+		private:
+			struct State
+			{
+				float z1 = 0.0f;
+				float z2 = 0.0f;
+			};
+
+			void updateCoefficients()noexcept
+			{
+				const float nyquist = m_Frequency * 0.5f;
+				const float cutoff = std::clamp(m_Cutoff.load(std::memory_order_relaxed), 10.0f, nyquist * 0.99f);
+				const float q = std::max(m_Q.load(std::memory_order_relaxed), 0.05f);
+				const float w0 = 2.0f * 3.14159265f * cutoff / m_Frequency;
+				const float cosw = std::cos(w0);
+				const float alpha = std::sin(w0) / (2.0f * q);
+				const float a0 = 1.0f + alpha;
+				const float b1 = m_Type == Type::LOW_PASS ? 1.0f - cosw : -(1.0f + cosw);
+				const float b0 = m_Type == Type::LOW_PASS ? b1 * 0.5f : -b1 * 0.5f;
+				m_B0 = b0 / a0;
+				m_B1 = b1 / a0;
+				m_B2 = b0 / a0;
+				m_A1 = -2.0f * cosw / a0;
+				m_A2 = (1.0f - alpha) / a0;
+			}
+
+			Type m_Type;
+			std::atomic<float> m_Cutoff;
+			std::atomic<float> m_Q;
+			std::atomic<bool> m_Dirty{ false };
+			float m_Frequency = 44100.0f;
+			float m_B0 = 1.0f, m_B1 = 0.0f, m_B2 = 0.0f, m_A1 = 0.0f, m_A2 = 0.0f;
+			std::array<State, MAX_CHANNELS> m_State{};
+		};
+
+		// Schroeder style reverb: four damped combs feeding two allpasses per channel.
+		class Reverb : public Effect
+		{
+		public:
+			[[nodiscard]] explicit Reverb(float roomSize = 0.7f, float damping = 0.3f, float wet = 0.25f)noexcept
+				: m_RoomSize(roomSize), m_Damping(damping), m_Wet(wet)
+			{}
+
+			void setRoomSize(float roomSize)noexcept { m_RoomSize.store(roomSize, std::memory_order_relaxed); }
+			void setDamping(float damping)noexcept { m_Damping.store(damping, std::memory_order_relaxed); }
+			void setWet(float wet)noexcept { m_Wet.store(wet, std::memory_order_relaxed); }
+
+			void prepare(int frequency, int channels, int)override
+			{
+				static constexpr std::array<int, COMBS> combTunings{ 1116, 1188, 1277, 1356 };
+				static constexpr std::array<int, ALLPASSES> allpassTunings{ 556, 441 };
+				const float ratio = static_cast<float>(frequency) / 44100.0f;
+				m_Lines.assign(static_cast<std::size_t>(std::min(channels, MAX_CHANNELS)), Line{});
+				for (std::size_t c = 0; c < m_Lines.size(); ++c)
+				{
+					const int spread = static_cast<int>(c) * 23;
+					for (std::size_t i = 0; i < COMBS; ++i)
+					{
+						m_Lines[c].combs[i].buffer.assign(static_cast<std::size_t>(static_cast<float>(combTunings[i] + spread) * ratio), 0.0f);
+					}
+					for (std::size_t i = 0; i < ALLPASSES; ++i)
+					{
+						m_Lines[c].allpasses[i].buffer.assign(static_cast<std::size_t>(static_cast<float>(allpassTunings[i] + spread) * ratio), 0.0f);
+					}
+				}
+			}
+
+			void process(float* samples, int frames, int channels)noexcept override
+			{
+				const float feedback = 0.7f + 0.28f * std::clamp(m_RoomSize.load(std::memory_order_relaxed), 0.0f, 1.0f);
+				const float damping = std::clamp(m_Damping.load(std::memory_order_relaxed), 0.0f, 1.0f);
+				const float wet = std::clamp(m_Wet.load(std::memory_order_relaxed), 0.0f, 1.0f);
+				const float dry = 1.0f - wet;
+				for (std::size_t c = 0; c < m_Lines.size(); ++c)
+				{
+					Line& line = m_Lines[c];
+					for (int frame = 0; frame < frames; ++frame)
+					{
+						float& x = samples[static_cast<std::size_t>(frame * channels) + c];
+						const float input = x * 0.015f;
+						float out = 0.0f;
+						for (Comb& comb : line.combs)
+						{
+							const float delayed = comb.buffer[comb.index];
+							comb.filter = delayed * (1.0f - damping) + comb.filter * damping;
+							comb.buffer[comb.index] = input + comb.filter * feedback;
+							comb.index = comb.index + 1 < comb.buffer.size() ? comb.index + 1 : 0;
+							out += delayed;
+						}
+						for (Allpass& allpass : line.allpasses)
+						{
+							const float delayed = allpass.buffer[allpass.index];
+							allpass.buffer[allpass.index] = out + delayed * 0.5f;
+							allpass.index = allpass.index + 1 < allpass.buffer.size() ? allpass.index + 1 : 0;
+							out = delayed - out;
+						}
+						x = x * dry + out * wet * 3.0f;
+					}
+				}
+			}
+
+		private:
+			static constexpr std::size_t COMBS = 4;
+			static constexpr std::size_t ALLPASSES = 2;
+
+			struct Comb
+			{
+				std::vector<float> buffer;
+				std::size_t index = 0;
+				float filter = 0.0f;
+			};
+
+			struct Allpass
+			{
+				std::vector<float> buffer;
+				std::size_t index = 0;
+			};
+
+			struct Line
+			{
+				std::array<Comb, COMBS> combs;
+				std::array<Allpass, ALLPASSES> allpasses;
+			};
+
+			std::atomic<float> m_RoomSize;
+			std::atomic<float> m_Damping;
+			std::atomic<float> m_Wet;
+			std::vector<Line> m_Lines;
+		};
+
+		// Feed-forward peak compressor with channel-linked detection.
+		// A ratio <= 1 means infinite ratio with a hard clip at the threshold (limiter).
+		class Compressor : public Effect
+		{
+		public:
+			[[nodiscard]] Compressor(float thresholdDb = -12.0f, float ratio = 4.0f, float attackMs = 5.0f, float releaseMs = 80.0f, float makeupDb = 0.0f)noexcept
+				: m_Threshold(thresholdDb), m_Ratio(ratio), m_Makeup(makeupDb), m_AttackMs(attackMs), m_ReleaseMs(releaseMs)
+			{}
+
+			void setThreshold(float decibels)noexcept { m_Threshold.store(decibels, std::memory_order_relaxed); }
+			void setRatio(float ratio)noexcept { m_Ratio.store(ratio, std::memory_order_relaxed); }
+			void setMakeup(float decibels)noexcept { m_Makeup.store(decibels, std::memory_order_relaxed); }
+
+			[[nodiscard]] float getGainReduction()const noexcept { return m_Reduction.load(std::memory_order_relaxed); }
+
+			void prepare(int frequency, int, int)override
+			{
+				const float rate = static_cast<float>(frequency);
+				m_Attack = std::exp(-1.0f / (std::max(m_AttackMs, 0.01f) * 0.001f * rate));
+				m_Release = std::exp(-1.0f / (std::max(m_ReleaseMs, 0.01f) * 0.001f * rate));
+				m_Envelope = 0.0f;
+				m_Gain = 1.0f;
+			}
+
+			void process(float* samples, int frames, int channels)noexcept override
+			{
+				const float threshold = dsp::decibelsToGain(m_Threshold.load(std::memory_order_relaxed));
+				const float ratio = m_Ratio.load(std::memory_order_relaxed);
+				const float slope = ratio > 1.0f ? 1.0f - 1.0f / ratio : 1.0f;
+				const float makeup = dsp::decibelsToGain(m_Makeup.load(std::memory_order_relaxed));
+				float minGain = 1.0f;
+				// The envelope follows every frame, but the gain curve is evaluated once per
+				// GAIN_INTERVAL frames and ramped in between, so std::pow does not run per sample.
+				for (int start = 0; start < frames; start += GAIN_INTERVAL)
+				{
+					const int count = std::min(GAIN_INTERVAL, frames - start);
+					float* block = samples + start * channels;
+					for (int frame = 0; frame < count; ++frame)
+					{
+						const float* data = block + frame * channels;
+						float level = 0.0f;
+						for (int c = 0; c < channels; ++c)
+						{
+							level = std::max(level, std::fabs(data[c]));
+						}
+						const float coefficient = level > m_Envelope ? m_Attack : m_Release;
+						m_Envelope = level + coefficient * (m_Envelope - level);
+					}
+					const float target = m_Envelope > threshold ? std::pow(threshold / m_Envelope, slope) : 1.0f;
+					minGain = std::min(minGain, target);
+					const float step = (target - m_Gain) / static_cast<float>(count);
+					for (int frame = 0; frame < count; ++frame)
+					{
+						float* data = block + frame * channels;
+						const float gain = (m_Gain + step * static_cast<float>(frame + 1)) * makeup;
+						for (int c = 0; c < channels; ++c)
+						{
+							data[c] = ratio > 1.0f ? data[c] * gain : std::clamp(data[c] * gain, -threshold, threshold);
+						}
+					}
+					m_Gain = target;
+				}
+				m_Reduction.store(dsp::gainToDecibels(minGain), std::memory_order_relaxed);
+			}
+
+		private:
+			static constexpr int GAIN_INTERVAL = 16;
+
+			std::atomic<float> m_Threshold;
+			std::atomic<float> m_Ratio;
+			std::atomic<float> m_Makeup;
+			std::atomic<float> m_Reduction{ 0.0f };
+			float m_AttackMs;
+			float m_ReleaseMs;
+			float m_Attack = 0.0f;
+			float m_Release = 0.0f;
+			float m_Envelope = 0.0f;
+			float m_Gain = 1.0f;
+		};
+
+		class Limiter : public Compressor
+		{
+		public:
+			[[nodiscard]] explicit Limiter(float ceilingDb = -0.3f, float releaseMs = 50.0f)noexcept : Compressor(ceilingDb, 0.0f, 0.1f, releaseMs) {}
+		};
+
+		// Holds the highest peak per channel until it is read by consumePeak().
+		class PeakMeter : public Effect
+		{
+		public:
+			void process(float* samples, int frames, int channels)noexcept override
+			{
+				const int count = std::min(channels, MAX_CHANNELS);
+				for (int c = 0; c < count; ++c)
+				{
+					const float value = dsp::peak(samples, static_cast<std::size_t>(frames), static_cast<std::size_t>(channels), static_cast<std::size_t>(c));
+					auto& slot = m_Peaks[static_cast<std::size_t>(c)];
+					float current = slot.load(std::memory_order_relaxed);
+					while (value > current && !slot.compare_exchange_weak(current, value, std::memory_order_relaxed))
+					{
+					}
+				}
+			}
+
+			[[nodiscard]] float getPeak(int channel)const noexcept { return m_Peaks[static_cast<std::size_t>(channel)].load(std::memory_order_relaxed); }
+
+			[[nodiscard]] float consumePeak(int channel)noexcept { return m_Peaks[static_cast<std::size_t>(channel)].exchange(0.0f, std::memory_order_relaxed); }
+
+		private:
+			std::array<std::atomic<float>, MAX_CHANNELS> m_Peaks{};
+		};
+	}
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "audio.hpp"
+#include "postMix.hpp"
+
+#include <SDL_audio.h>
+#include <SDL_mutex.h>
+#include <SDL_rwops.h>
+#include <SDL_stdinc.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sdl2::mixer
+{
+	// Runs SDL_mixer faster than real time and captures its output.
+	// Call useDiskDriver() before the audio subsystem is initialised, open the mixer with
+	// mixer::openAudio() so its device is known, and attach() right after. The device then stays
+	// paused and only advances inside render(): the post-mix hook captures whole callbacks and
+	// pauses the device again once the requested amount of frames has been produced, so the
+	// output only depends on the scene.
+	// SDL_mixer fades and expirations are timed with SDL_GetTicks and are therefore not
+	// reproducible here; use effects::Gain ramps for deterministic fades.
+	class OfflineRenderer
+	{
+	public:
+		// The disk driver writes the device output to a file and with a delay of 0 does not throttle.
+		static void useDiskDriver(const std::string& discardFile =
+#ifdef _WIN32
+			"NUL"
+#else
+			"/dev/null"
+#endif
+		)
+		{
+			SDL_setenv("SDL_AUDIODRIVER", "disk", 1);
+			SDL_setenv("SDL_DISKAUDIOFILE", discardFile.c_str(), 1);
+			SDL_setenv("SDL_DISKAUDIODELAY", "0", 1);
+		}
+
+		[[nodiscard]] OfflineRenderer() : m_Done(SDL_CreateSemaphore(0)) {}
+
+		OfflineRenderer(const OfflineRenderer&) = delete;
+		OfflineRenderer& operator=(const OfflineRenderer&) = delete;
+
+		~OfflineRenderer()noexcept
+		{
+			detach();
+			closeWav();
+			SDL_DestroySemaphore(m_Done);
+		}
+
+		// Captures in the CAPTURE stage, i.e. after post-mix effect chains.
+		bool attach()
+		{
+			detach();
+			if (!sdl2::mixer::querySpec(m_Frequency, m_Format, m_Channels) || m_Channels <= 0 || m_Done == nullptr)
+			{
+				return false;
+			}
+			m_FrameBytes = m_Channels * (SDL_AUDIO_BITSIZE(m_Format) / 8);
+			sdl2::mixer::pauseAudio(true);
+			m_Attached = PostMixDispatcher::add(&OfflineRenderer::onPostMix, this, PostMixStage::CAPTURE);
+			return m_Attached;
+		}
+
+		void detach()noexcept
+		{
+			if (m_Attached)
+			{
+				sdl2::mixer::pauseAudio(true);
+				PostMixDispatcher::remove(&OfflineRenderer::onPostMix, this);
+				m_Attached = false;
+			}
+		}
+
+		// Renders at least the given amount of frames (rounded up to whole callbacks) and returns
+		// the amount actually produced, 0 on timeout.
+		std::int64_t render(std::int64_t frames, std::chrono::milliseconds timeout = std::chrono::seconds{ 10 })
+		{
+			if (!m_Attached || frames <= 0)
+			{
+				return 0;
+			}
+			// A post left over from a render that timed out must not end this one early.
+			while (SDL_SemTryWait(m_Done) == 0)
+			{
+			}
+			const std::int64_t start = m_Rendered.load(std::memory_order_acquire);
+			m_Target.store(start + frames, std::memory_order_release);
+			m_IsRendering.store(true, std::memory_order_release);
+			sdl2::mixer::pauseAudio(false);
+			if (SDL_SemWaitTimeout(m_Done, static_cast<std::uint32_t>(timeout.count())) != 0)
+			{
+				sdl2::mixer::pauseAudio(true);
+				m_IsRendering.store(false, std::memory_order_release);
+				return 0;
+			}
+			return m_Rendered.load(std::memory_order_acquire) - start;
+		}
+
+		std::int64_t render(std::chrono::milliseconds duration) { return render(duration.count() * m_Frequency / 1000); }
+
+		void captureToMemory(bool enable)noexcept { m_CaptureMemory = enable; }
+
+		[[nodiscard]] const std::vector<std::uint8_t>& getCaptured()const noexcept { return m_Captured; }
+
+		void clearCaptured()noexcept { m_Captured.clear(); }
+
+		bool openWav(const std::string& file)
+		{
+			closeWav();
+			if (!m_Attached || (m_Format != AUDIO_S16SYS && m_Format != AUDIO_F32SYS))
+			{
+				return false;
+			}
+			m_Wav = SDL_RWFromFile(file.c_str(), "wb");
+			if (m_Wav == nullptr)
+			{
+				return false;
+			}
+			m_WavBytes = 0;
+			writeWavHeader();
+			return true;
+		}
+
+		bool closeWav()
+		{
+			if (m_Wav == nullptr)
+			{
+				return false;
+			}
+			SDL_RWseek(m_Wav, 0, RW_SEEK_SET);
+			writeWavHeader();
+			const bool success = SDL_RWclose(m_Wav) == 0;
+			m_Wav = nullptr;
+			return success;
+		}
+
+		[[nodiscard]] std::int64_t getRenderedFrames()const noexcept { return m_Rendered.load(std::memory_order_acquire); }
+
+		[[nodiscard]] int getFrequency()const noexcept { return m_Frequency; }
+
+		[[nodiscard]] int getChannels()const noexcept { return m_Channels; }
+
+		[[nodiscard]] std::uint16_t getFormat()const noexcept { return m_Format; }
+
+	private:
+		void writeWavHeader()
+		{
+			const bool isFloat = m_Format == AUDIO_F32SYS;
+			const auto bytesPerSample = static_cast<std::uint16_t>(isFloat ? 4 : 2);
+			const auto blockAlign = static_cast<std::uint16_t>(bytesPerSample * m_Channels);
+			SDL_RWwrite(m_Wav, "RIFF", 1, 4);
+			SDL_WriteLE32(m_Wav, 36u + m_WavBytes);
+			SDL_RWwrite(m_Wav, "WAVEfmt ", 1, 8);
+			SDL_WriteLE32(m_Wav, 16u);
+			SDL_WriteLE16(m_Wav, static_cast<std::uint16_t>(isFloat ? 3 : 1));
+			SDL_WriteLE16(m_Wav, static_cast<std::uint16_t>(m_Channels));
+			SDL_WriteLE32(m_Wav, static_cast<std::uint32_t>(m_Frequency));
+			SDL_WriteLE32(m_Wav, static_cast<std::uint32_t>(m_Frequency) * blockAlign);
+			SDL_WriteLE16(m_Wav, blockAlign);
+			SDL_WriteLE16(m_Wav, static_cast<std::uint16_t>(bytesPerSample * 8));
+			SDL_RWwrite(m_Wav, "data", 1, 4);
+			SDL_WriteLE32(m_Wav, m_WavBytes);
+		}
+
+		void onMixed(std::uint8_t* stream, int len)
+		{
+			const std::int64_t target = m_Target.load(std::memory_order_acquire);
+			std::int64_t rendered = m_Rendered.load(std::memory_order_relaxed);
+			if (rendered >= target || len <= 0)
+			{
+				return;
+			}
+			if (m_CaptureMemory)
+			{
+				m_Captured.insert(m_Captured.end(), stream, stream + len);
+			}
+			if (m_Wav != nullptr)
+			{
+				SDL_RWwrite(m_Wav, stream, 1, static_cast<std::size_t>(len));
+				m_WavBytes += static_cast<std::uint32_t>(len);
+			}
+			rendered += len / m_FrameBytes;
+			m_Rendered.store(rendered, std::memory_order_release);
+			// Only the callback that completes a render wakes it.
+			if (rendered >= target && m_IsRendering.exchange(false, std::memory_order_acq_rel))
+			{
+				// The device lock is recursive and already held by this thread.
+				sdl2::mixer::pauseAudio(true);
+				SDL_SemPost(m_Done);
+			}
+		}
+
+		static void onPostMix(void* udata, std::uint8_t* stream, int len) { static_cast<OfflineRenderer*>(udata)->onMixed(stream, len); }
+
+		SDL_sem* m_Done;
+		std::atomic<std::int64_t> m_Target{ 0 };
+		std::atomic<std::int64_t> m_Rendered{ 0 };
+		std::atomic<bool> m_IsRendering{ false };
+		std::vector<std::uint8_t> m_Captured;
+		bool m_CaptureMemory = true;
+		SDL_RWops* m_Wav = nullptr;
+		std::uint32_t m_WavBytes = 0;
+		int m_Frequency = 0;
+		std::uint16_t m_Format = 0;
+		int m_Channels = 0;
+		int m_FrameBytes = 1;
+		bool m_Attached = false;
+	};
+}
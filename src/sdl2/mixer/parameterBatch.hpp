@@ -0,0 +1,208 @@
+#pragma once
+
+#include "../spscQueue.hpp"
+#include "audio.hpp"
+#include "channel.hpp"
+#include "postMix.hpp"
+
+#include <SDL_audio.h>
+#include <SDL_mixer.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace sdl2::mixer
+{
+	// Collects channel and music parameter changes during a frame without touching SDL_mixer.
+	// submit() publishes the frame's changes to the audio thread, where they are applied together
+	// from the post-mix hook, i.e. before the next callback starts mixing. Updates to the same
+	// channel parameter within one frame are coalesced, last write wins.
+	class ParameterBatch
+	{
+	public:
+		[[nodiscard]] explicit ParameterBatch(int channelsCount, std::size_t capacity = 1024)
+			: m_Queue(capacity)
+			, m_Slots(static_cast<std::size_t>(std::max(channelsCount, 0) + 1) * PARAMETERS_COUNT, NO_SLOT)
+		{
+			m_Pending.reserve(capacity);
+		}
+
+		[[nodiscard]] ParameterBatch()
+			: ParameterBatch(Mix_AllocateChannels(-1))
+		{}
+
+		ParameterBatch(const ParameterBatch&) = delete;
+		ParameterBatch& operator=(const ParameterBatch&) = delete;
+
+		~ParameterBatch()noexcept { detach(); }
+
+		// Applies submitted batches in the PARAMETERS stage, after every other post-mix listener.
+		bool attach()
+		{
+			m_Attached = m_Attached || PostMixDispatcher::add(&ParameterBatch::onPostMix, this, PostMixStage::PARAMETERS);
+			return m_Attached;
+		}
+
+		void detach()noexcept
+		{
+			if (m_Attached)
+			{
+				PostMixDispatcher::remove(&ParameterBatch::onPostMix, this);
+				m_Attached = false;
+			}
+		}
+
+		bool setVolume(sdl2::mixer::Channel channel, int volume) { return queue(channel.get(), Parameter::VOLUME, volume, 0); }
+
+		bool setPanning(sdl2::mixer::Channel channel, std::uint8_t left, std::uint8_t right) { return queue(channel.get(), Parameter::PANNING, left, right); }
+
+		bool setPosition(sdl2::mixer::Channel channel, std::int16_t angle, std::uint8_t distance) { return queue(channel.get(), Parameter::POSITION, angle, distance); }
+
+		bool setDistance(sdl2::mixer::Channel channel, std::uint8_t distance) { return queue(channel.get(), Parameter::DISTANCE, distance, 0); }
+
+		bool setMusicVolume(int volume) { return queue(MUSIC, Parameter::MUSIC_VOLUME, volume, 0); }
+
+		// Publishes every update queued since the previous submit as one batch.
+		// Returns false when the queue to the audio thread is full; the updates stay pending.
+		bool submit()
+		{
+			if (m_Pending.empty())
+			{
+				return true;
+			}
+			if (m_Queue.capacity() - m_Queue.size() < m_Pending.size())
+			{
+				return false;
+			}
+			for (const Update& update : m_Pending)
+			{
+				m_Queue.push(update);
+			}
+			m_Submitted.fetch_add(m_Pending.size(), std::memory_order_release);
+			clearPending();
+			return true;
+		}
+
+		// Applies the pending updates on the calling thread under a single audio lock.
+		// Use it when no post-mix hook is attached (e.g. audio paused).
+		void applyNow()
+		{
+			sdl2::mixer::lockAudio();
+			for (const Update& update : m_Pending)
+			{
+				apply(update);
+			}
+			sdl2::mixer::unlockAudio();
+			clearPending();
+		}
+
+		[[nodiscard]] std::size_t getPendingCount()const noexcept { return m_Pending.size(); }
+
+		[[nodiscard]] std::uint64_t getAppliedCount()const noexcept { return m_AppliedTotal.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr int MUSIC = -1;
+		static constexpr std::uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+		enum class Parameter : std::uint8_t
+		{
+			VOLUME,
+			PANNING,
+			POSITION,
+			DISTANCE,
+			MUSIC_VOLUME,
+			COUNT
+		};
+
+		static constexpr std::size_t PARAMETERS_COUNT = static_cast<std::size_t>(Parameter::COUNT);
+
+		struct Update
+		{
+			int channel = 0;
+			Parameter parameter = Parameter::VOLUME;
+			int a = 0;
+			int b = 0;
+		};
+
+		bool queue(int channel, Parameter parameter, int a, int b)
+		{
+			const auto key = static_cast<std::size_t>(channel + 1) * PARAMETERS_COUNT + static_cast<std::size_t>(parameter);
+			if (channel < MUSIC || key >= m_Slots.size())
+			{
+				return false;
+			}
+			if (m_Slots[key] != NO_SLOT)
+			{
+				Update& update = m_Pending[m_Slots[key]];
+				update.a = a;
+				update.b = b;
+				return true;
+			}
+			if (m_Pending.size() == m_Pending.capacity())
+			{
+				return false;
+			}
+			m_Slots[key] = static_cast<std::uint32_t>(m_Pending.size());
+			m_Pending.push_back(Update{ channel, parameter, a, b });
+			return true;
+		}
+
+		void clearPending()noexcept
+		{
+			for (const Update& update : m_Pending)
+			{
+				m_Slots[static_cast<std::size_t>(update.channel + 1) * PARAMETERS_COUNT + static_cast<std::size_t>(update.parameter)] = NO_SLOT;
+			}
+			m_Pending.clear();
+		}
+
+		static void apply(const Update& update)noexcept
+		{
+			const sdl2::mixer::Channel channel{ update.channel };
+			switch (update.parameter)
+			{
+			case Parameter::VOLUME:
+				Mix_Volume(update.channel, update.a);
+				break;
+			case Parameter::PANNING:
+				channel.setPanning(static_cast<std::uint8_t>(update.a), static_cast<std::uint8_t>(update.b));
+				break;
+			case Parameter::POSITION:
+				channel.setPosition(static_cast<std::int16_t>(update.a), static_cast<std::uint8_t>(update.b));
+				break;
+			case Parameter::DISTANCE:
+				channel.setDistance(static_cast<std::uint8_t>(update.a));
+				break;
+			case Parameter::MUSIC_VOLUME:
+				Mix_VolumeMusic(update.a);
+				break;
+			case Parameter::COUNT:
+				break;
+			}
+		}
+
+		// Runs on the audio thread with the device already locked, so the Mix_* calls only re-enter the lock.
+		void applySubmitted()noexcept
+		{
+			const std::size_t submitted = m_Submitted.load(std::memory_order_acquire);
+			Update update;
+			while (m_Applied < submitted && m_Queue.pop(update))
+			{
+				apply(update);
+				++m_Applied;
+			}
+			m_AppliedTotal.store(m_Applied, std::memory_order_relaxed);
+		}
+
+		static void onPostMix(void* udata, std::uint8_t*, int) { static_cast<ParameterBatch*>(udata)->applySubmitted(); }
+
+		sdl2::SpscQueue<Update> m_Queue;
+		std::vector<Update> m_Pending;
+		std::vector<std::uint32_t> m_Slots;
+		std::atomic<std::size_t> m_Submitted{ 0 };
+		std::atomic<std::uint64_t> m_AppliedTotal{ 0 };
+		std::size_t m_Applied = 0;
+		bool m_Attached = false;
+	};
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "audio.hpp"
+
+#include <SDL_audio.h>
+#include <SDL_mixer.h>
+#include <array>
+#include <cstdint>
+
+namespace sdl2::mixer
+{
+	// Where a post-mix listener runs relative to the others.
+	enum class PostMixStage : std::uint8_t
+	{
+		EFFECTS,	// modifies the mixed stream
+		CAPTURE,	// reads the final stream
+		CLOCK,		// only looks at its length
+		PARAMETERS	// prepares the next callback
+	};
+
+	// SDL_mixer has a single post-mix slot. The dispatcher owns it and calls an ordered list of
+	// listeners, so each user adds and removes only itself and teardown order does not matter.
+	// The list is changed under the mixer device lock (mixer::lockAudio()) and never allocates.
+	// Calling setPostMix() directly replaces the dispatcher.
+	class PostMixDispatcher
+	{
+	public:
+		static constexpr std::size_t MAX_LISTENERS = 16;
+
+		// Listeners run by stage, then in the order they were added. Returns false when the list is
+		// full or the listener is already added.
+		static bool add(OnMixingPerformed callback, void* arg, PostMixStage stage)
+		{
+			if (callback == nullptr)
+			{
+				return false;
+			}
+			sdl2::mixer::lockAudio();
+			State& state = getState();
+			const bool isAdded = state.size < MAX_LISTENERS && find(state, callback, arg) == state.size;
+			if (isAdded)
+			{
+				std::size_t index = state.size;
+				while (index > 0 && state.listeners[index - 1].stage > stage)
+				{
+					state.listeners[index] = state.listeners[index - 1];
+					--index;
+				}
+				state.listeners[index] = Listener{ callback, arg, stage };
+				if (state.size++ == 0)
+				{
+					sdl2::mixer::setPostMix(&PostMixDispatcher::dispatch, nullptr);
+				}
+			}
+			sdl2::mixer::unlockAudio();
+			return isAdded;
+		}
+
+		static bool remove(OnMixingPerformed callback, void* arg)noexcept
+		{
+			sdl2::mixer::lockAudio();
+			State& state = getState();
+			const std::size_t index = find(state, callback, arg);
+			const bool isRemoved = index < state.size;
+			if (isRemoved)
+			{
+				for (std::size_t i = index + 1; i < state.size; ++i)
+				{
+					state.listeners[i - 1] = state.listeners[i];
+				}
+				if (--state.size == 0)
+				{
+					sdl2::mixer::setPostMix(nullptr, nullptr);
+				}
+			}
+			sdl2::mixer::unlockAudio();
+			return isRemoved;
+		}
+
+		[[nodiscard]] static std::size_t getSize()noexcept
+		{
+			sdl2::mixer::lockAudio();
+			const std::size_t size = getState().size;
+			sdl2::mixer::unlockAudio();
+			return size;
+		}
+
+	private:
+		struct Listener
+		{
+			OnMixingPerformed callback = nullptr;
+			void* arg = nullptr;
+			PostMixStage stage = PostMixStage::EFFECTS;
+		};
+
+		struct State
+		{
+			std::array<Listener, MAX_LISTENERS> listeners{};
+			std::size_t size = 0;
+		};
+
+		[[nodiscard]] static State& getState()noexcept
+		{
+			static State state;
+			return state;
+		}
+
+		[[nodiscard]] static std::size_t find(const State& state, OnMixingPerformed callback, void* arg)noexcept
+		{
+			for (std::size_t i = 0; i < state.size; ++i)
+			{
+				if (state.listeners[i].callback == callback && state.listeners[i].arg == arg)
+				{
+					return i;
+				}
+			}
+			return state.size;
+		}
+
+		// Runs on the audio thread with the device locked.
+		static void dispatch(void*, std::uint8_t* stream, int len)
+		{
+			const State& state = getState();
+			for (std::size_t i = 0; i < state.size; ++i)
+			{
+				state.listeners[i].callback(state.listeners[i].arg, stream, len);
+			}
+		}
+	};
+}
@@ -1,10 +1,12 @@
 #pragma once
 
 #include "channel.hpp"
+#include "../trace.hpp"
 
 #include <SDL_mixer.h>
 #include <utility>
 #include <chrono>
+#include <memory>
 #include <string>
 
 namespace sdl2::mixer
@@ -14,7 +16,15 @@ namespace sdl2::mixer
 	public:
 		[[nodiscard]] constexpr Sound()noexcept = default;
 		[[nodiscard]] Sound(const std::string& file)noexcept
-			: m_Sound(Mix_LoadWAV(file.c_str()))
+		{
+			SDL2_TRACE_SCOPE("load", "Sound::load");
+			m_Sound = Mix_LoadWAV(file.c_str());
+		}
+
+		// Takes a chunk whose samples are owned elsewhere (e.g. from Mix_QuickLoad_RAW); owner keeps them alive.
+		[[nodiscard]] Sound(Mix_Chunk* chunk, std::shared_ptr<void> owner)noexcept
+			: m_Sound(chunk)
+			, m_Owner(std::move(owner))
 		{}
 
 		~Sound()noexcept
@@ -26,7 +36,7 @@ namespace sdl2::mixer
 		}
 
 		Sound(Sound&) = delete;
-		[[nodiscard]] Sound(Sound&& s) noexcept : m_Sound(s.m_Sound) { s.m_Sound = nullptr; };
+		[[nodiscard]] Sound(Sound&& s) noexcept : m_Sound(s.m_Sound), m_Owner(std::move(s.m_Owner)) { s.m_Sound = nullptr; };
 
 		Sound& operator=(Sound&) = delete;
 		Sound& operator=(Sound&& other) noexcept
@@ -35,6 +45,7 @@ namespace sdl2::mixer
 			{
 				Mix_FreeChunk(m_Sound);
 				m_Sound = other.m_Sound;
+				m_Owner = std::move(other.m_Owner);
 			}
 			other.m_Sound = nullptr;
 			return *this;
@@ -68,6 +79,7 @@ namespace sdl2::mixer
 
 	protected:
 		Mix_Chunk* m_Sound = nullptr;
+		std::shared_ptr<void> m_Owner;
 
 	};
 }
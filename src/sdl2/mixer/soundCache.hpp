@@ -0,0 +1,290 @@
+#pragma once
+
+#include "audio.hpp"
+#include "sound.hpp"
+
+#include <SDL_audio.h>
+#include <SDL_mixer.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sdl2::mixer
+{
+	enum class SoundStorage
+	{
+		PCM,   // decoded device format, kept resident
+		PCM8,  // 8 bits per sample, 2:1
+		ADPCM, // IMA ADPCM, 4:1
+	};
+
+	struct SoundCacheStats
+	{
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+		std::uint64_t decodes = 0;
+	};
+
+	// Decodes each file once per device spec and hands out Sounds sharing the samples.
+	// Every Sound gets its own Mix_QuickLoad_RAW chunk (so per-sound volume still works) that
+	// points into the cached buffer. Compressed entries keep only the packed data resident and
+	// are expanded when a Sound is acquired; the expanded samples are dropped again once the
+	// last Sound using them is gone. Compression needs a 16-bit device format, otherwise the
+	// entry is stored as PCM.
+	class SoundCache
+	{
+	public:
+		[[nodiscard]] SoundCache() = default;
+
+		SoundCache(const SoundCache&) = delete;
+		SoundCache& operator=(const SoundCache&) = delete;
+
+		[[nodiscard]] Sound acquire(const std::string& file, SoundStorage storage = SoundStorage::PCM)
+		{
+			Entry* entry = find(file, storage);
+			if (entry == nullptr)
+			{
+				return Sound{};
+			}
+			std::shared_ptr<Samples> samples = entry->resident ? entry->resident : entry->expanded.lock();
+			if (!samples)
+			{
+				samples = expand(*entry);
+				entry->expanded = samples;
+				++m_Stats.decodes;
+			}
+			Mix_Chunk* chunk = Mix_QuickLoad_RAW(samples->data, samples->size);
+			if (chunk == nullptr)
+			{
+				return Sound{};
+			}
+			return Sound{ chunk, std::move(samples) };
+		}
+
+		bool preload(const std::string& file, SoundStorage storage = SoundStorage::PCM) { return find(file, storage) != nullptr; }
+
+		// Drops PCM entries nobody is playing from and entries decoded for a different device spec.
+		void purge()
+		{
+			const std::string spec = getSpecKey();
+			for (auto it = m_Entries.begin(); it != m_Entries.end();)
+			{
+				const bool stale = it->first.compare(0, spec.size(), spec) != 0;
+				const bool unused = it->second.resident && it->second.resident.use_count() == 1;
+				it = stale || unused ? m_Entries.erase(it) : std::next(it);
+			}
+		}
+
+		void clear()noexcept { m_Entries.clear(); }
+
+		[[nodiscard]] std::size_t getSize()const noexcept { return m_Entries.size(); }
+
+		// Bytes held by the cache itself, shared PCM plus packed data.
+		[[nodiscard]] std::size_t getResidentBytes()const noexcept
+		{
+			std::size_t bytes = 0;
+			for (const auto& [key, entry] : m_Entries)
+			{
+				bytes += entry.resident ? entry.resident->size : entry.packed.size();
+			}
+			return bytes;
+		}
+
+		[[nodiscard]] const SoundCacheStats& getStats()const noexcept { return m_Stats; }
+
+		void resetStats()noexcept { m_Stats = SoundCacheStats{}; }
+
+	private:
+		struct Samples
+		{
+			std::shared_ptr<Mix_Chunk> chunk;
+			std::vector<std::uint8_t> buffer;
+			std::uint8_t* data = nullptr;
+			std::uint32_t size = 0;
+		};
+
+		struct Entry
+		{
+			SoundStorage storage = SoundStorage::PCM;
+			std::shared_ptr<Samples> resident;
+			std::weak_ptr<Samples> expanded;
+			std::vector<std::uint8_t> packed;
+			std::uint32_t samplesCount = 0;
+			int channels = 0;
+		};
+
+		[[nodiscard]] static std::string getSpecKey()
+		{
+			int frequency = 0;
+			std::uint16_t format = 0;
+			int channels = 0;
+			if (!sdl2::mixer::querySpec(frequency, format, channels))
+			{
+				return {};
+			}
+			return std::to_string(frequency) + ':' + std::to_string(format) + ':' + std::to_string(channels) + '|';
+		}
+
+		Entry* find(const std::string& file, SoundStorage storage)
+		{
+			std::string key = getSpecKey();
+			if (key.empty())
+			{
+				return nullptr;
+			}
+			key += file;
+			if (const auto it = m_Entries.find(key); it != m_Entries.end())
+			{
+				++m_Stats.hits;
+				return &it->second;
+			}
+			++m_Stats.misses;
+
+			std::shared_ptr<Mix_Chunk> chunk{ Mix_LoadWAV(file.c_str()), Mix_FreeChunk };
+			if (!chunk || chunk->abuf == nullptr)
+			{
+				return nullptr;
+			}
+			++m_Stats.decodes;
+
+			int frequency = 0;
+			std::uint16_t format = 0;
+			Entry entry;
+			sdl2::mixer::querySpec(frequency, format, entry.channels);
+			entry.storage = format == AUDIO_S16SYS ? storage : SoundStorage::PCM;
+			if (entry.storage == SoundStorage::PCM)
+			{
+				auto samples = std::make_shared<Samples>();
+				samples->data = chunk->abuf;
+				samples->size = chunk->alen;
+				samples->chunk = std::move(chunk);
+				entry.resident = std::move(samples);
+			}
+			else
+			{
+				const auto* pcm = reinterpret_cast<const std::int16_t*>(chunk->abuf);
+				entry.samplesCount = chunk->alen / 2;
+				entry.packed = entry.storage == SoundStorage::PCM8
+					? packPcm8(pcm, entry.samplesCount)
+					: packAdpcm(pcm, entry.samplesCount, entry.channels);
+			}
+			return &m_Entries.emplace(std::move(key), std::move(entry)).first->second;
+		}
+
+		[[nodiscard]] static std::shared_ptr<Samples> expand(const Entry& entry)
+		{
+			auto samples = std::make_shared<Samples>();
+			samples->buffer.resize(static_cast<std::size_t>(entry.samplesCount) * 2);
+			auto* pcm = reinterpret_cast<std::int16_t*>(samples->buffer.data());
+			if (entry.storage == SoundStorage::PCM8)
+			{
+				unpackPcm8(entry.packed, pcm, entry.samplesCount);
+			}
+			else
+			{
+				unpackAdpcm(entry.packed, pcm, entry.samplesCount, entry.channels);
+			}
+			samples->data = samples->buffer.data();
+			samples->size = static_cast<std::uint32_t>(samples->buffer.size());
+			return samples;
+		}
+
+		[[nodiscard]] static std::vector<std::uint8_t> packPcm8(const std::int16_t* pcm, std::uint32_t count)
+		{
+			std::vector<std::uint8_t> packed(count);
+			for (std::uint32_t i = 0; i < count; ++i)
+			{
+				const int rounded = std::min((pcm[i] + 128) >> 8, 127);
+				packed[i] = static_cast<std::uint8_t>(rounded + 128);
+			}
+			return packed;
+		}
+
+		static void unpackPcm8(const std::vector<std::uint8_t>& packed, std::int16_t* pcm, std::uint32_t count)noexcept
+		{
+			for (std::uint32_t i = 0; i < count; ++i)
+			{
+				pcm[i] = static_cast<std::int16_t>((packed[i] - 128) * 256);
+			}
+		}
+
+		static constexpr std::array<int, 16> ADPCM_INDEX_TABLE{ -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+
+		static constexpr std::array<int, 89> ADPCM_STEP_TABLE{
+			7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97,
+			107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+			876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428,
+			4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
+			22385, 24623, 27086, 29794, 32767 };
+
+		static constexpr int MAX_CHANNELS = 8;
+
+		struct AdpcmState
+		{
+			int predictor = 0;
+			int index = 0;
+
+			int decode(std::uint8_t nibble)noexcept
+			{
+				const int step = ADPCM_STEP_TABLE[static_cast<std::size_t>(index)];
+				int difference = step >> 3;
+				if (nibble & 4) { difference += step; }
+				if (nibble & 2) { difference += step >> 1; }
+				if (nibble & 1) { difference += step >> 2; }
+				predictor = std::clamp(nibble & 8 ? predictor - difference : predictor + difference, -32768, 32767);
+				index = std::clamp(index + ADPCM_INDEX_TABLE[nibble], 0, 88);
+				return predictor;
+			}
+
+			std::uint8_t encode(int sample)noexcept
+			{
+				const int step = ADPCM_STEP_TABLE[static_cast<std::size_t>(index)];
+				int difference = sample - predictor;
+				std::uint8_t nibble = 0;
+				if (difference < 0)
+				{
+					nibble = 8;
+					difference = -difference;
+				}
+				if (difference >= step) { nibble |= 4; difference -= step; }
+				if (difference >= step >> 1) { nibble |= 2; difference -= step >> 1; }
+				if (difference >= step >> 2) { nibble |= 1; }
+				// Track the decoder so errors do not accumulate.
+				decode(nibble);
+				return nibble;
+			}
+		};
+
+		// Samples stay interleaved; each channel runs its own predictor.
+		[[nodiscard]] static std::vector<std::uint8_t> packAdpcm(const std::int16_t* pcm, std::uint32_t count, int channels)
+		{
+			std::array<AdpcmState, MAX_CHANNELS> states{};
+			const auto stride = static_cast<std::uint32_t>(std::clamp(channels, 1, MAX_CHANNELS));
+			std::vector<std::uint8_t> packed((count + 1) / 2, 0);
+			for (std::uint32_t i = 0; i < count; ++i)
+			{
+				const std::uint8_t nibble = states[i % stride].encode(pcm[i]);
+				packed[i / 2] |= static_cast<std::uint8_t>(i % 2 == 0 ? nibble : nibble << 4);
+			}
+			return packed;
+		}
+
+		static void unpackAdpcm(const std::vector<std::uint8_t>& packed, std::int16_t* pcm, std::uint32_t count, int channels)noexcept
+		{
+			std::array<AdpcmState, MAX_CHANNELS> states{};
+			const auto stride = static_cast<std::uint32_t>(std::clamp(channels, 1, MAX_CHANNELS));
+			for (std::uint32_t i = 0; i < count; ++i)
+			{
+				const auto nibble = static_cast<std::uint8_t>(i % 2 == 0 ? packed[i / 2] & 0x0F : packed[i / 2] >> 4);
+				pcm[i] = static_cast<std::int16_t>(states[i % stride].decode(nibble));
+			}
+		}
+
+		std::unordered_map<std::string, Entry> m_Entries;
+		SoundCacheStats m_Stats;
+	};
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include "channel.hpp"
+#include "channelGroup.hpp"
+#include "sound.hpp"
+
+#include <SDL_mixer.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace sdl2::mixer
+{
+	struct VoiceRequest
+	{
+		int priority = 0;
+		float volume = 1.0f;
+		float distance = 0.0f;
+		int loops = 0;
+	};
+
+	struct VoiceStats
+	{
+		std::uint32_t requested = 0;
+		std::uint32_t played = 0;
+		std::uint32_t stolen = 0;
+		std::uint32_t dropped = 0;
+		std::uint32_t collapsed = 0;
+		int active = 0;
+		int peakActive = 0;
+	};
+
+	// Assigns mixer channels to sounds by priority, audibility and age.
+	// Every playing voice is grouped under a tag derived from its priority so that
+	// the oldest voice of a tier can be found with Mix_GroupOldest.
+	class VoiceManager
+	{
+	public:
+		[[nodiscard]] explicit VoiceManager(int firstChannel, int channelsCount, std::chrono::milliseconds duplicateWindow = std::chrono::milliseconds{ 30 }, int priorityTagBase = 1000)
+			: m_FirstChannel(firstChannel)
+			, m_PriorityTagBase(priorityTagBase)
+			, m_DuplicateWindow(static_cast<std::uint32_t>(duplicateWindow.count()))
+			, m_Voices(static_cast<std::size_t>(std::max(channelsCount, 0)))
+		{}
+
+		[[nodiscard]] explicit VoiceManager(std::chrono::milliseconds duplicateWindow = std::chrono::milliseconds{ 30 })
+			: VoiceManager(0, Mix_AllocateChannels(-1), duplicateWindow)
+		{}
+
+		VoiceManager(const VoiceManager&) = delete;
+		VoiceManager& operator=(const VoiceManager&) = delete;
+
+		~VoiceManager()noexcept
+		{
+			for (std::size_t i = 0; i < m_Voices.size(); ++i)
+			{
+				Mix_GroupChannel(channelAt(i), -1);
+			}
+		}
+
+		sdl2::mixer::Channel play(sdl2::mixer::Sound& sound, const VoiceRequest& request = {})
+		{
+			++m_Stats.requested;
+			if (!sound.isValid() || m_Voices.empty())
+			{
+				++m_Stats.dropped;
+				return sdl2::mixer::Channel{ -1 };
+			}
+
+			const std::uint32_t now = SDL_GetTicks();
+			const float audibility = computeAudibility(request);
+
+			int free = -1;
+			for (std::size_t i = 0; i < m_Voices.size(); ++i)
+			{
+				Voice& voice = m_Voices[i];
+				if (!voice.active)
+				{
+					if (free < 0)
+					{
+						free = static_cast<int>(i);
+					}
+					continue;
+				}
+				if (Mix_Playing(channelAt(i)) == 0)
+				{
+					release(i);
+					if (free < 0)
+					{
+						free = static_cast<int>(i);
+					}
+					continue;
+				}
+				if (voice.chunk == sound.get() && now - voice.startTicks <= m_DuplicateWindow)
+				{
+					if (audibility > voice.audibility)
+					{
+						voice.audibility = audibility;
+						applyMix(i, request);
+					}
+					if (request.priority > voice.priority)
+					{
+						voice.priority = request.priority;
+						sdl2::mixer::Channel{ channelAt(i) }.group(tagFor(voice.priority));
+					}
+					++m_Stats.collapsed;
+					return sdl2::mixer::Channel{ channelAt(i) };
+				}
+			}
+
+			if (free < 0)
+			{
+				free = findVictim(request.priority, audibility);
+				if (free < 0)
+				{
+					++m_Stats.dropped;
+					return sdl2::mixer::Channel{ -1 };
+				}
+				sdl2::mixer::Channel{ channelAt(static_cast<std::size_t>(free)) }.halt();
+				release(static_cast<std::size_t>(free));
+				++m_Stats.stolen;
+			}
+
+			const auto index = static_cast<std::size_t>(free);
+			auto channel = sound.play(request.loops, sdl2::mixer::Channel{ channelAt(index) });
+			if (channel.get() < 0)
+			{
+				++m_Stats.dropped;
+				return channel;
+			}
+
+			Voice& voice = m_Voices[index];
+			voice.active = true;
+			voice.chunk = sound.get();
+			voice.priority = request.priority;
+			voice.audibility = audibility;
+			voice.startTicks = now;
+			channel.group(tagFor(request.priority));
+			applyMix(index, request);
+
+			++m_Stats.played;
+			++m_Stats.active;
+			m_Stats.peakActive = std::max(m_Stats.peakActive, m_Stats.active);
+			return channel;
+		}
+
+		void update()
+		{
+			for (std::size_t i = 0; i < m_Voices.size(); ++i)
+			{
+				if (m_Voices[i].active && Mix_Playing(channelAt(i)) == 0)
+				{
+					release(i);
+				}
+			}
+		}
+
+		void haltAll()
+		{
+			for (std::size_t i = 0; i < m_Voices.size(); ++i)
+			{
+				if (m_Voices[i].active)
+				{
+					sdl2::mixer::Channel{ channelAt(i) }.halt();
+					release(i);
+				}
+			}
+		}
+
+		[[nodiscard]] sdl2::mixer::ChannelGroup getPriorityGroup(int priority)const noexcept { return sdl2::mixer::ChannelGroup{ tagFor(priority) }; }
+
+		[[nodiscard]] const VoiceStats& getStats()const noexcept { return m_Stats; }
+
+		void resetStats()noexcept
+		{
+			const int active = m_Stats.active;
+			m_Stats = VoiceStats{};
+			m_Stats.active = active;
+			m_Stats.peakActive = active;
+		}
+
+		[[nodiscard]] int getChannelsCount()const noexcept { return static_cast<int>(m_Voices.size()); }
+
+	private:
+		struct Voice
+		{
+			bool active = false;
+			Mix_Chunk* chunk = nullptr;
+			int priority = 0;
+			float audibility = 0.0f;
+			std::uint32_t startTicks = 0;
+		};
+
+		[[nodiscard]] static float computeAudibility(const VoiceRequest& request)noexcept
+		{
+			const float volume = std::clamp(request.volume, 0.0f, 1.0f);
+			const float distance = std::clamp(request.distance, 0.0f, 1.0f);
+			return volume * (1.0f - distance);
+		}
+
+		[[nodiscard]] constexpr int channelAt(std::size_t index)const noexcept { return m_FirstChannel + static_cast<int>(index); }
+
+		[[nodiscard]] constexpr int tagFor(int priority)const noexcept { return m_PriorityTagBase + priority; }
+
+		void applyMix(std::size_t index, const VoiceRequest& request)
+		{
+			sdl2::mixer::Channel channel{ channelAt(index) };
+			channel.setDistance(static_cast<std::uint8_t>(std::clamp(request.distance, 0.0f, 1.0f) * 255.0f));
+			channel.setVolume(static_cast<int>(std::clamp(request.volume, 0.0f, 1.0f) * MIX_MAX_VOLUME));
+		}
+
+		void release(std::size_t index)noexcept
+		{
+			Voice& voice = m_Voices[index];
+			if (voice.active)
+			{
+				voice.active = false;
+				voice.chunk = nullptr;
+				--m_Stats.active;
+				Mix_GroupChannel(channelAt(index), -1);
+			}
+		}
+
+		// Lowest priority tier loses first. Inside the tier the least audible voice
+		// is taken; when the whole tier is equally audible SDL_mixer picks the oldest.
+		[[nodiscard]] int findVictim(int priority, float audibility)const
+		{
+			int lowest = priority + 1;
+			for (const Voice& voice : m_Voices)
+			{
+				if (voice.active)
+				{
+					lowest = std::min(lowest, voice.priority);
+				}
+			}
+			if (lowest > priority)
+			{
+				return -1;
+			}
+
+			int quietest = -1;
+			bool uniform = true;
+			for (std::size_t i = 0; i < m_Voices.size(); ++i)
+			{
+				const Voice& voice = m_Voices[i];
+				if (!voice.active || voice.priority != lowest)
+				{
+					continue;
+				}
+				if (quietest < 0)
+				{
+					quietest = static_cast<int>(i);
+					continue;
+				}
+				const Voice& current = m_Voices[static_cast<std::size_t>(quietest)];
+				if (voice.audibility != current.audibility)
+				{
+					uniform = false;
+				}
+				if (voice.audibility < current.audibility || (voice.audibility == current.audibility && voice.startTicks < current.startTicks))
+				{
+					quietest = static_cast<int>(i);
+				}
+			}
+			if (quietest < 0)
+			{
+				return -1;
+			}
+			if (lowest == priority && m_Voices[static_cast<std::size_t>(quietest)].audibility >= audibility)
+			{
+				return -1;
+			}
+			if (uniform)
+			{
+				const int oldest = getPriorityGroup(lowest).findOldestSample() - m_FirstChannel;
+				// Tags outlive the sound, so the oldest tagged channel may already have finished.
+				if (oldest >= 0 && oldest < static_cast<int>(m_Voices.size()) && isVictim(m_Voices[static_cast<std::size_t>(oldest)], lowest))
+				{
+					return oldest;
+				}
+			}
+			return quietest;
+		}
+
+		[[nodiscard]] static bool isVictim(const Voice& voice, int priority)noexcept { return voice.active && voice.priority == priority; }
+
+		int m_FirstChannel;
+		int m_PriorityTagBase;
+		std::uint32_t m_DuplicateWindow;
+		std::vector<Voice> m_Voices;
+		VoiceStats m_Stats;
+	};
+}
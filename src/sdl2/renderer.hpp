@@ -1,11 +1,14 @@
 #pragma once
 
-#include "window.hpp"
+#include "span.hpp"
 #include "surface.hpp"
+#include "window.hpp"
 
 #include <SDL_render.h>
+#include <SDL_version.h>
 #include <utility>
 #include <optional>
+#include <vector>
 
 namespace sdl2
 {
@@ -25,6 +28,13 @@ namespace sdl2
 	}
 
 
+	// One textured quad of a batched copy.
+	struct TextureCopy
+	{
+		SDL_Rect source;
+		SDL_FRect destination;
+	};
+
 	class Renderer
 	{
 	public:
@@ -173,8 +183,8 @@ namespace sdl2
 		bool draw(int x, int y) { return SDL_RenderDrawPoint(m_Renderer, x, y) == 0; }
 		bool draw(float x, float y) { return SDL_RenderDrawPointF(m_Renderer, x, y) == 0; }
 
-		bool draw(SDL_Point start, SDL_Point end) { return SDL_RenderDrawLine(m_Renderer, start.x, start.y, end.x, end.x) == 0; }
-		bool draw(SDL_FPoint start, SDL_FPoint end) { return SDL_RenderDrawLineF(m_Renderer, start.x, start.y, end.x, end.x) == 0; }
+		bool draw(SDL_Point start, SDL_Point end) { return SDL_RenderDrawLine(m_Renderer, start.x, start.y, end.x, end.y) == 0; }
+		bool draw(SDL_FPoint start, SDL_FPoint end) { return SDL_RenderDrawLineF(m_Renderer, start.x, start.y, end.x, end.y) == 0; }
 
 		bool drawFilled(const SDL_Rect& rect)const noexcept { return SDL_RenderFillRect(m_Renderer, &rect) == 0; }
 		bool drawFilled(const SDL_FRect& rect)const noexcept { return SDL_RenderFillRectF(m_Renderer, &rect) == 0; }
@@ -182,17 +192,29 @@ namespace sdl2
 		bool drawFilled(const SDL_Rect* rects, int count)const noexcept { return SDL_RenderFillRects(m_Renderer, rects, count) == 0; }
 		bool drawFilled(const SDL_FRect* rects, int count)const noexcept { return SDL_RenderFillRectsF(m_Renderer, rects, count) == 0; }
 
+		bool drawFilled(Span<const SDL_Rect> rects)const noexcept { return drawFilled(rects.data(), static_cast<int>(rects.size())); }
+		bool drawFilled(Span<const SDL_FRect> rects)const noexcept { return drawFilled(rects.data(), static_cast<int>(rects.size())); }
+
 		bool drawOutlined(const SDL_Rect& rect)const noexcept { return SDL_RenderDrawRect(m_Renderer, &rect) == 0; }
 		bool drawOutlined(const SDL_FRect& rect)const noexcept { return SDL_RenderDrawRectF(m_Renderer, &rect) == 0; }
 
 		bool drawOutlined(const SDL_Rect* rects, int count)const noexcept { return SDL_RenderDrawRects(m_Renderer, rects, count) == 0; }
 		bool drawOutlined(const SDL_FRect* rects, int count)const noexcept { return SDL_RenderDrawRectsF(m_Renderer, rects, count) == 0; }
 
+		bool drawOutlined(Span<const SDL_Rect> rects)const noexcept { return drawOutlined(rects.data(), static_cast<int>(rects.size())); }
+		bool drawOutlined(Span<const SDL_FRect> rects)const noexcept { return drawOutlined(rects.data(), static_cast<int>(rects.size())); }
+
 		bool drawPoints(const SDL_Point* points, int count) { return SDL_RenderDrawPoints(m_Renderer, points, count) == 0; }
 		bool drawPoints(const SDL_FPoint* points, int count) { return SDL_RenderDrawPointsF(m_Renderer, points, count) == 0; }
 
-		bool drawLines(const SDL_Point* line, int count) { return SDL_RenderDrawPoints(m_Renderer, line, count) == 0; }
-		bool drawLines(const SDL_FPoint* line, int count) { return SDL_RenderDrawPointsF(m_Renderer, line, count) == 0; }
+		bool drawPoints(Span<const SDL_Point> points) { return drawPoints(points.data(), static_cast<int>(points.size())); }
+		bool drawPoints(Span<const SDL_FPoint> points) { return drawPoints(points.data(), static_cast<int>(points.size())); }
+
+		bool drawLines(const SDL_Point* line, int count) { return SDL_RenderDrawLines(m_Renderer, line, count) == 0; }
+		bool drawLines(const SDL_FPoint* line, int count) { return SDL_RenderDrawLinesF(m_Renderer, line, count) == 0; }
+
+		bool drawLines(Span<const SDL_Point> line) { return drawLines(line.data(), static_cast<int>(line.size())); }
+		bool drawLines(Span<const SDL_FPoint> line) { return drawLines(line.data(), static_cast<int>(line.size())); }
 
 		bool draw(TextureView texture, const SDL_Rect& source, const SDL_Rect& destination) { return SDL_RenderCopy(m_Renderer, texture, &source, &destination) == 0; }
 		bool draw(TextureView texture, const SDL_Rect& source, const SDL_FRect& destination) { return SDL_RenderCopyF(m_Renderer, texture, &source, &destination) == 0; }
@@ -200,10 +222,80 @@ namespace sdl2
 		bool draw(TextureView texture, const SDL_Rect& source, const SDL_Rect& destination, const double angle, const SDL_Point& center, const SDL_RendererFlip flip) { return SDL_RenderCopyEx(m_Renderer, texture, &source, &destination, angle, &center, flip) == 0; }
 		bool draw(TextureView texture, const SDL_Rect& source, const SDL_FRect& destination, const double angle, const SDL_FPoint& center, const SDL_RendererFlip flip) { return SDL_RenderCopyExF(m_Renderer, texture, &source, &destination, angle, &center, flip) == 0; }
 
+		// Copies many parts of one texture. With SDL 2.0.18 or newer they go out as a single geometry
+		// submission carrying the texture color and alpha mod, otherwise as a tight RenderCopy loop.
+		bool draw(TextureView texture, Span<const TextureCopy> copies)
+		{
+			if (copies.empty())
+			{
+				return true;
+			}
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+			int w = 0;
+			int h = 0;
+			SDL_Color color{ 255, 255, 255, 255 };
+			if (SDL_QueryTexture(texture, nullptr, nullptr, &w, &h) != 0 || w <= 0 || h <= 0)
+			{
+				return false;
+			}
+			SDL_GetTextureColorMod(texture, &color.r, &color.g, &color.b);
+			SDL_GetTextureAlphaMod(texture, &color.a);
+
+			thread_local std::vector<SDL_Vertex> vertices;
+			thread_local std::vector<int> indices;
+			vertices.resize(copies.size() * 4);
+			indices.resize(copies.size() * 6);
+			const float invW = 1.0f / static_cast<float>(w);
+			const float invH = 1.0f / static_cast<float>(h);
+			for (std::size_t i = 0; i < copies.size(); ++i)
+			{
+				const SDL_Rect& src = copies[i].source;
+				const SDL_FRect& dst = copies[i].destination;
+				const float u0 = static_cast<float>(src.x) * invW;
+				const float v0 = static_cast<float>(src.y) * invH;
+				const float u1 = static_cast<float>(src.x + src.w) * invW;
+				const float v1 = static_cast<float>(src.y + src.h) * invH;
+				SDL_Vertex* quad = &vertices[i * 4];
+				quad[0] = SDL_Vertex{ { dst.x, dst.y }, color, { u0, v0 } };
+				quad[1] = SDL_Vertex{ { dst.x + dst.w, dst.y }, color, { u1, v0 } };
+				quad[2] = SDL_Vertex{ { dst.x + dst.w, dst.y + dst.h }, color, { u1, v1 } };
+				quad[3] = SDL_Vertex{ { dst.x, dst.y + dst.h }, color, { u0, v1 } };
+				const int base = static_cast<int>(i * 4);
+				int* index = &indices[i * 6];
+				index[0] = base;
+				index[1] = base + 1;
+				index[2] = base + 2;
+				index[3] = base;
+				index[4] = base + 2;
+				index[5] = base + 3;
+			}
+			return drawGeometry(texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size()));
+#else
+			bool success = true;
+			for (const TextureCopy& copy : copies)
+			{
+				success &= SDL_RenderCopyF(m_Renderer, texture, &copy.source, &copy.destination) == 0;
+			}
+			return success;
+#endif
+		}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		bool drawGeometry(TextureView texture, const SDL_Vertex* vertices, int count, const int* indices = nullptr, int indicesCount = 0) { return SDL_RenderGeometry(m_Renderer, texture, vertices, count, indices, indicesCount) == 0; }
+		bool drawGeometry(TextureView texture, Span<const SDL_Vertex> vertices, Span<const int> indices = {}) { return drawGeometry(texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size())); }
+#endif
+
 		bool readPixels(const SDL_Rect& rect, std::uint32_t format, void* pixels, int pitch) { return SDL_RenderReadPixels(m_Renderer, &rect, format, pixels, pitch) == 0; }
 
 		bool clear()noexcept { return SDL_RenderClear(m_Renderer) == 0; }
-		void present()noexcept { SDL_RenderPresent(m_Renderer); }
+		void present()noexcept
+		{
+			SDL2_TRACE_SCOPE("render", "Renderer::present");
+			SDL_RenderPresent(m_Renderer);
+		}
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		bool setVSync(bool enable)noexcept { return SDL_RenderSetVSync(m_Renderer, enable ? 1 : 0) == 0; }
+#endif
 		bool flush()noexcept { return SDL_RenderFlush(m_Renderer) == 0; }
 
 		void* getMetalLayer() { return SDL_RenderGetMetalLayer(m_Renderer); }
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace sdl2
+{
+	// Non-owning view over contiguous elements, a small stand-in for C++20 std::span.
+	// Converts implicitly from arrays and from any container with data() and size().
+	template<class T>
+	class Span
+	{
+	public:
+		constexpr Span()noexcept = default;
+
+		constexpr Span(T* data, std::size_t size)noexcept
+			: m_Data(data)
+			, m_Size(size)
+		{}
+
+		template<std::size_t N>
+		constexpr Span(T(&array)[N])noexcept
+			: m_Data(array)
+			, m_Size(N)
+		{}
+
+		template<class Container, class = std::enable_if_t<
+			!std::is_same_v<std::decay_t<Container>, Span>
+			&& std::is_convertible_v<std::remove_pointer_t<decltype(std::data(std::declval<Container&>()))>(*)[], T(*)[]>>>
+		constexpr Span(Container&& container)noexcept
+			: m_Data(std::data(container))
+			, m_Size(std::size(container))
+		{}
+
+		[[nodiscard]] constexpr T* data()const noexcept { return m_Data; }
+
+		[[nodiscard]] constexpr std::size_t size()const noexcept { return m_Size; }
+
+		[[nodiscard]] constexpr bool empty()const noexcept { return m_Size == 0; }
+
+		[[nodiscard]] constexpr T& operator[](std::size_t index)const noexcept { return m_Data[index]; }
+
+		[[nodiscard]] constexpr T* begin()const noexcept { return m_Data; }
+
+		[[nodiscard]] constexpr T* end()const noexcept { return m_Data + m_Size; }
+
+		[[nodiscard]] constexpr Span subspan(std::size_t offset, std::size_t count)const noexcept { return Span{ m_Data + offset, count }; }
+
+	private:
+		T* m_Data = nullptr;
+		std::size_t m_Size = 0;
+	};
+}
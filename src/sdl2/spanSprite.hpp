@@ -0,0 +1,301 @@
+#pragma once
+
+#include "surface.hpp"
+
+#include <SDL_endian.h>
+#include <SDL_pixels.h>
+#include <SDL_rwops.h>
+#include <SDL_surface.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace sdl2
+{
+	// Horizontal run of non transparent pixels of one sprite row.
+	struct SpanRun
+	{
+		std::uint16_t x = 0;
+		std::uint16_t length = 0;
+		std::uint32_t pixels = 0; // index of the first pixel in SpanSprite::getPixels()
+		bool isOpaque = false;
+	};
+
+	// ARGB8888 sprite stored as per-row runs of opaque and translucent pixels; fully transparent
+	// pixels are not stored at all. Unlike Surface::setRLE the encoding is done once, offline,
+	// and saved to disk. blit() skips the gaps, copies opaque runs with memcpy and blends only
+	// the translucent ones, so mostly transparent UI sprites cost what they cover.
+	class SpanSprite
+	{
+	public:
+		[[nodiscard]] SpanSprite() = default;
+
+		// Any format SDL can convert; pixels with alpha 0 are dropped.
+		[[nodiscard]] static SpanSprite encode(const sdl2::Surface& surface)
+		{
+			SpanSprite sprite;
+			if (!surface.isValid() || surface.getWidth() > 0xFFFF)
+			{
+				return sprite;
+			}
+			sdl2::Surface converted;
+			const sdl2::Surface* source = &surface;
+			if (surface.getPixelFormat()->format != SDL_PIXELFORMAT_ARGB8888)
+			{
+				converted = surface.convert(SDL_PIXELFORMAT_ARGB8888);
+				if (!converted.isValid())
+				{
+					return sprite;
+				}
+				source = &converted;
+			}
+			sprite.m_Width = source->getWidth();
+			sprite.m_Height = source->getHeight();
+			sprite.m_Rows.reserve(static_cast<std::size_t>(sprite.m_Height) + 1);
+			const auto* pixels = static_cast<const std::uint8_t*>(source->getPixels());
+			for (int y = 0; y < sprite.m_Height; ++y)
+			{
+				sprite.m_Rows.push_back(static_cast<std::uint32_t>(sprite.m_Runs.size()));
+				const auto* row = reinterpret_cast<const std::uint32_t*>(pixels + static_cast<std::ptrdiff_t>(y) * source->getPitch());
+				for (int x = 0; x < sprite.m_Width;)
+				{
+					const std::uint32_t alpha = row[x] >> 24;
+					if (alpha == 0)
+					{
+						++x;
+						continue;
+					}
+					const bool isOpaque = alpha == 0xFF;
+					int end = x + 1;
+					while (end < sprite.m_Width && end - x < MAX_RUN_LENGTH && ((row[end] >> 24) == 0xFF) == isOpaque && (row[end] >> 24) != 0)
+					{
+						++end;
+					}
+					sprite.m_Runs.push_back(SpanRun{ static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(end - x), static_cast<std::uint32_t>(sprite.m_Pixels.size()), isOpaque });
+					sprite.m_Pixels.insert(sprite.m_Pixels.end(), row + x, row + end);
+					x = end;
+				}
+			}
+			sprite.m_Rows.push_back(static_cast<std::uint32_t>(sprite.m_Runs.size()));
+			return sprite;
+		}
+
+		// Draws the sprite with its top left corner at x, y, clipped to the destination clip rectangle.
+		// The destination must be ARGB8888 or RGB888; translucent runs are blended source-over.
+		bool blit(sdl2::Surface& destination, int x, int y)const noexcept
+		{
+			SDL_Surface* dst = destination.get();
+			if (dst == nullptr || (dst->format->format != SDL_PIXELFORMAT_ARGB8888 && dst->format->format != SDL_PIXELFORMAT_RGB888))
+			{
+				return false;
+			}
+			const SDL_Rect clip = dst->clip_rect;
+			const int rowBegin = std::max(y, clip.y);
+			const int rowEnd = std::min(y + m_Height, clip.y + clip.h);
+			const int columnBegin = std::max(x, clip.x);
+			const int columnEnd = std::min(x + m_Width, clip.x + clip.w);
+			if (rowBegin >= rowEnd || columnBegin >= columnEnd)
+			{
+				return true;
+			}
+			const bool mustLock = SDL_MUSTLOCK(dst);
+			if (mustLock && SDL_LockSurface(dst) < 0)
+			{
+				return false;
+			}
+			const bool hasAlpha = dst->format->format == SDL_PIXELFORMAT_ARGB8888;
+			auto* target = static_cast<std::uint8_t*>(dst->pixels);
+			for (int row = rowBegin; row < rowEnd; ++row)
+			{
+				auto* out = reinterpret_cast<std::uint32_t*>(target + static_cast<std::ptrdiff_t>(row) * dst->pitch);
+				const auto spriteRow = static_cast<std::size_t>(row - y);
+				for (std::uint32_t i = m_Rows[spriteRow]; i < m_Rows[spriteRow + 1]; ++i)
+				{
+					const SpanRun& run = m_Runs[i];
+					const int begin = std::max(x + run.x, columnBegin);
+					const int end = std::min(x + run.x + run.length, columnEnd);
+					if (begin >= end)
+					{
+						if (x + run.x >= columnEnd)
+						{
+							break;
+						}
+						continue;
+					}
+					const std::uint32_t* in = m_Pixels.data() + run.pixels + (begin - x - run.x);
+					if (run.isOpaque)
+					{
+						std::memcpy(out + begin, in, static_cast<std::size_t>(end - begin) * sizeof(std::uint32_t));
+					}
+					else
+					{
+						blend(out + begin, in, end - begin, hasAlpha);
+					}
+				}
+			}
+			if (mustLock)
+			{
+				SDL_UnlockSurface(dst);
+			}
+			return true;
+		}
+
+		bool save(const std::string& file)const
+		{
+			SDL_RWops* rw = SDL_RWFromFile(file.c_str(), "wb");
+			if (rw == nullptr)
+			{
+				return false;
+			}
+			bool success = SDL_WriteLE32(rw, MAGIC) == 1
+				&& SDL_WriteLE32(rw, static_cast<std::uint32_t>(m_Width)) == 1 && SDL_WriteLE32(rw, static_cast<std::uint32_t>(m_Height)) == 1
+				&& SDL_WriteLE32(rw, static_cast<std::uint32_t>(m_Runs.size())) == 1 && SDL_WriteLE32(rw, static_cast<std::uint32_t>(m_Pixels.size())) == 1;
+			// Runs are stored per row; the pixel indices are implied by the order.
+			for (std::size_t row = 0; success && row + 1 < m_Rows.size(); ++row)
+			{
+				success = SDL_WriteLE16(rw, static_cast<std::uint16_t>(m_Rows[row + 1] - m_Rows[row])) == 1;
+			}
+			for (std::size_t i = 0; success && i < m_Runs.size(); ++i)
+			{
+				const SpanRun& run = m_Runs[i];
+				success = SDL_WriteLE16(rw, run.x) == 1 && SDL_WriteLE16(rw, static_cast<std::uint16_t>(run.length | (run.isOpaque ? OPAQUE_BIT : 0))) == 1;
+			}
+			if (success)
+			{
+				std::vector<std::uint32_t> pixels(m_Pixels.size());
+				std::transform(m_Pixels.begin(), m_Pixels.end(), pixels.begin(), [](std::uint32_t pixel) { return SDL_SwapLE32(pixel); });
+				success = SDL_RWwrite(rw, pixels.data(), sizeof(std::uint32_t), pixels.size()) == pixels.size();
+			}
+			return SDL_RWclose(rw) == 0 && success;
+		}
+
+		// Returns an empty sprite if the file is missing or malformed.
+		[[nodiscard]] static SpanSprite load(const std::string& file)
+		{
+			SpanSprite sprite;
+			SDL_RWops* rw = SDL_RWFromFile(file.c_str(), "rb");
+			if (rw == nullptr)
+			{
+				return sprite;
+			}
+			bool success = SDL_ReadLE32(rw) == MAGIC;
+			const std::uint32_t width = success ? SDL_ReadLE32(rw) : 0;
+			const std::uint32_t height = success ? SDL_ReadLE32(rw) : 0;
+			const std::uint32_t runsCount = success ? SDL_ReadLE32(rw) : 0;
+			const std::uint32_t pixelsCount = success ? SDL_ReadLE32(rw) : 0;
+			success = success && width <= 0xFFFF && height <= 0xFFFF && runsCount <= width * height && pixelsCount <= width * height;
+			if (success)
+			{
+				sprite.m_Width = static_cast<int>(width);
+				sprite.m_Height = static_cast<int>(height);
+				sprite.m_Rows.reserve(height + 1);
+				sprite.m_Runs.resize(runsCount);
+				sprite.m_Rows.push_back(0);
+				for (std::uint32_t row = 0; success && row < height; ++row)
+				{
+					sprite.m_Rows.push_back(sprite.m_Rows.back() + SDL_ReadLE16(rw));
+				}
+				success = sprite.m_Rows.back() == runsCount;
+				std::uint32_t pixels = 0;
+				for (std::size_t i = 0; success && i < sprite.m_Runs.size(); ++i)
+				{
+					SpanRun& run = sprite.m_Runs[i];
+					run.x = SDL_ReadLE16(rw);
+					const std::uint16_t length = SDL_ReadLE16(rw);
+					run.length = static_cast<std::uint16_t>(length & ~OPAQUE_BIT);
+					run.isOpaque = (length & OPAQUE_BIT) != 0;
+					run.pixels = pixels;
+					pixels += run.length;
+					success = run.x + run.length <= width;
+				}
+				success = success && pixels == pixelsCount;
+			}
+			if (success)
+			{
+				sprite.m_Pixels.resize(pixelsCount);
+				success = SDL_RWread(rw, sprite.m_Pixels.data(), sizeof(std::uint32_t), pixelsCount) == pixelsCount;
+				for (std::uint32_t& pixel : sprite.m_Pixels)
+				{
+					pixel = SDL_SwapLE32(pixel);
+				}
+			}
+			SDL_RWclose(rw);
+			return success ? std::move(sprite) : SpanSprite{};
+		}
+
+		// Expands the sprite back into a new ARGB8888 surface.
+		[[nodiscard]] sdl2::Surface decode()const
+		{
+			sdl2::Surface surface{ 0, m_Width, m_Height, 32, SDL_PIXELFORMAT_ARGB8888 };
+			if (surface.isValid())
+			{
+				surface.fill(SDL_Rect{ 0, 0, m_Width, m_Height }, 0);
+				SDL_SetSurfaceBlendMode(surface.get(), SDL_BLENDMODE_BLEND);
+				auto* pixels = static_cast<std::uint8_t*>(surface.getPixels());
+				for (std::size_t row = 0; row + 1 < m_Rows.size(); ++row)
+				{
+					auto* out = reinterpret_cast<std::uint32_t*>(pixels + static_cast<std::ptrdiff_t>(row) * surface.getPitch());
+					for (std::uint32_t i = m_Rows[row]; i < m_Rows[row + 1]; ++i)
+					{
+						const SpanRun& run = m_Runs[i];
+						std::memcpy(out + run.x, m_Pixels.data() + run.pixels, run.length * sizeof(std::uint32_t));
+					}
+				}
+			}
+			return surface;
+		}
+
+		[[nodiscard]] bool isValid()const noexcept { return !m_Rows.empty(); }
+
+		[[nodiscard]] int getWidth()const noexcept { return m_Width; }
+
+		[[nodiscard]] int getHeight()const noexcept { return m_Height; }
+
+		[[nodiscard]] const std::vector<SpanRun>& getRuns()const noexcept { return m_Runs; }
+
+		[[nodiscard]] const std::vector<std::uint32_t>& getPixels()const noexcept { return m_Pixels; }
+
+		[[nodiscard]] std::size_t getMemoryUsage()const noexcept
+		{
+			return m_Rows.size() * sizeof(std::uint32_t) + m_Runs.size() * sizeof(SpanRun) + m_Pixels.size() * sizeof(std::uint32_t);
+		}
+
+	private:
+		static constexpr std::uint32_t MAGIC = 0x314E5053; // "SPN1"
+		static constexpr std::uint16_t OPAQUE_BIT = 0x8000;
+		// The saved length shares 16 bits with OPAQUE_BIT, so longer runs are split.
+		static constexpr int MAX_RUN_LENGTH = OPAQUE_BIT - 1;
+
+		// Non premultiplied source-over; the destination alpha is kept up to date for ARGB8888.
+		static void blend(std::uint32_t* out, const std::uint32_t* in, int count, bool hasAlpha)noexcept
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				const std::uint32_t s = in[i];
+				const std::uint32_t d = out[i];
+				const std::uint32_t a = s >> 24;
+				const std::uint32_t inv = 255 - a;
+				// Red and blue share one multiply, green rides in a second one.
+				std::uint32_t rb = (s & 0x00FF00FFu) * a + (d & 0x00FF00FFu) * inv + 0x00800080u;
+				rb = ((rb + ((rb >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+				std::uint32_t g = (s & 0x0000FF00u) * a + (d & 0x0000FF00u) * inv + 0x00008000u;
+				g = ((g + ((g >> 8) & 0x0000FF00u)) >> 8) & 0x0000FF00u;
+				std::uint32_t da = 0xFFu;
+				if (hasAlpha)
+				{
+					const std::uint32_t t = (d >> 24) * inv + 128;
+					da = a + ((t + (t >> 8)) >> 8);
+				}
+				out[i] = (da << 24) | rb | g;
+			}
+		}
+
+		int m_Width = 0;
+		int m_Height = 0;
+		std::vector<std::uint32_t> m_Rows;
+		std::vector<SpanRun> m_Runs;
+		std::vector<std::uint32_t> m_Pixels;
+	};
+}
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "renderer.hpp"
+
+#include <SDL_rect.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace sdl2
+{
+	// Uniform hash grid of axis aligned boxes for culling draw submissions.
+	// Each item is listed in every cell its box touches; update() only touches the grid when the
+	// covered cell range changes, so small moves are O(1). A query visits the cells overlapping the
+	// area and reports each intersecting item once, so its cost follows the number of items near
+	// the area rather than the size of the world. Boxes covering more than MAX_ITEM_CELLS cells
+	// are kept in a separate list that every query checks.
+	class SpatialGrid
+	{
+	public:
+		using Handle = std::uint32_t;
+
+		static constexpr Handle INVALID = 0xFFFFFFFFu;
+		static constexpr int MAX_ITEM_CELLS = 64;
+
+		[[nodiscard]] explicit SpatialGrid(float cellSize = 256.0f)noexcept
+			: m_CellSize(std::max(cellSize, 1.0f))
+			, m_InvCellSize(1.0f / m_CellSize)
+		{}
+
+		Handle insert(const SDL_FRect& bounds, std::uint32_t userData)
+		{
+			Handle handle = INVALID;
+			if (!m_FreeItems.empty())
+			{
+				handle = m_FreeItems.back();
+				m_FreeItems.pop_back();
+			}
+			else
+			{
+				handle = static_cast<Handle>(m_Items.size());
+				m_Items.emplace_back();
+			}
+			Item& item = m_Items[handle];
+			item.bounds = bounds;
+			item.userData = userData;
+			item.isAlive = true;
+			item.range = getRange(bounds);
+			link(handle, item.range);
+			++m_Size;
+			return handle;
+		}
+
+		// Returns false for handles that were never inserted or are already removed.
+		bool update(Handle handle, const SDL_FRect& bounds)
+		{
+			if (!contains(handle))
+			{
+				return false;
+			}
+			Item& item = m_Items[handle];
+			item.bounds = bounds;
+			const CellRange range = getRange(bounds);
+			if (range != item.range)
+			{
+				unlink(handle, item.range);
+				item.range = range;
+				link(handle, range);
+			}
+			return true;
+		}
+
+		bool remove(Handle handle)
+		{
+			if (!contains(handle))
+			{
+				return false;
+			}
+			Item& item = m_Items[handle];
+			unlink(handle, item.range);
+			item.isAlive = false;
+			m_FreeItems.push_back(handle);
+			--m_Size;
+			return true;
+		}
+
+		[[nodiscard]] bool contains(Handle handle)const noexcept { return handle < m_Items.size() && m_Items[handle].isAlive; }
+
+		void clear()noexcept
+		{
+			m_Cells.clear();
+			m_Items.clear();
+			m_FreeItems.clear();
+			m_Oversized.clear();
+			m_Size = 0;
+		}
+
+		// Calls onItem(handle, userData, bounds) once for every item intersecting area.
+		template<class OnItem>
+		void query(const SDL_FRect& area, OnItem&& onItem)
+		{
+			if (++m_Stamp == 0)
+			{
+				for (Item& item : m_Items)
+				{
+					item.stamp = 0;
+				}
+				m_Stamp = 1;
+			}
+			const auto visit = [&](Handle handle)
+			{
+				Item& item = m_Items[handle];
+				if (item.stamp != m_Stamp)
+				{
+					item.stamp = m_Stamp;
+					if (intersects(item.bounds, area))
+					{
+						onItem(handle, item.userData, item.bounds);
+					}
+				}
+			};
+			const CellRange range = getRange(area);
+			if (range.getCellsCount() > static_cast<std::int64_t>(m_Cells.size()))
+			{
+				// The area covers more cells than exist, walk the occupied ones instead.
+				for (const auto& [key, handles] : m_Cells)
+				{
+					for (const Handle handle : handles)
+					{
+						visit(handle);
+					}
+				}
+			}
+			else
+			{
+				for (int y = range.y0; y <= range.y1; ++y)
+				{
+					for (int x = range.x0; x <= range.x1; ++x)
+					{
+						if (const auto it = m_Cells.find(getKey(x, y)); it != m_Cells.end())
+						{
+							for (const Handle handle : it->second)
+							{
+								visit(handle);
+							}
+						}
+					}
+				}
+			}
+			for (const Handle handle : m_Oversized)
+			{
+				visit(handle);
+			}
+		}
+
+		// Appends the user data of the visible items to out.
+		template<class Allocator>
+		std::size_t query(const SDL_FRect& area, std::vector<std::uint32_t, Allocator>& out)
+		{
+			const std::size_t before = out.size();
+			query(area, [&](Handle, std::uint32_t userData, const SDL_FRect&) { out.push_back(userData); });
+			return out.size() - before;
+		}
+
+		// World area shown by the renderer when its top left corner sits at camera.
+		// SDL reports the viewport in logical units, i.e. with the logical size and scale applied.
+		[[nodiscard]] static SDL_FRect getVisibleArea(sdl2::Renderer& renderer, SDL_FPoint camera = { 0.0f, 0.0f })
+		{
+			const SDL_Rect viewport = renderer.getViewport();
+			SDL_FPoint size{ static_cast<float>(viewport.w), static_cast<float>(viewport.h) };
+			if (viewport.w <= 0 || viewport.h <= 0)
+			{
+				const SDL_Point logical = renderer.getLogicalSize();
+				const SDL_FPoint scale = renderer.getScale();
+				size = SDL_FPoint{ static_cast<float>(logical.x) / std::max(scale.x, 1e-6f), static_cast<float>(logical.y) / std::max(scale.y, 1e-6f) };
+			}
+			return SDL_FRect{ camera.x, camera.y, size.x, size.y };
+		}
+
+		[[nodiscard]] std::size_t getSize()const noexcept { return m_Size; }
+
+		[[nodiscard]] std::size_t getCellsCount()const noexcept { return m_Cells.size(); }
+
+		[[nodiscard]] float getCellSize()const noexcept { return m_CellSize; }
+
+	private:
+		struct CellRange
+		{
+			int x0 = 0;
+			int y0 = 0;
+			int x1 = -1;
+			int y1 = -1;
+
+			[[nodiscard]] bool operator!=(const CellRange& other)const noexcept { return x0 != other.x0 || y0 != other.y0 || x1 != other.x1 || y1 != other.y1; }
+
+			// Cell coordinates reach +-1e9, so the product needs 64 bits.
+			[[nodiscard]] std::int64_t getCellsCount()const noexcept { return (static_cast<std::int64_t>(x1) - x0 + 1) * (static_cast<std::int64_t>(y1) - y0 + 1); }
+		};
+
+		struct Item
+		{
+			SDL_FRect bounds{ 0.0f, 0.0f, 0.0f, 0.0f };
+			std::uint32_t userData = 0;
+			CellRange range;
+			std::uint32_t stamp = 0;
+			bool isAlive = false;
+		};
+
+		[[nodiscard]] static bool intersects(const SDL_FRect& a, const SDL_FRect& b)noexcept
+		{
+			return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+		}
+
+		[[nodiscard]] static std::uint64_t getKey(int x, int y)noexcept
+		{
+			return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+		}
+
+		[[nodiscard]] int toCell(float value)const noexcept
+		{
+			return static_cast<int>(std::clamp(std::floor(value * m_InvCellSize), -1e9f, 1e9f));
+		}
+
+		[[nodiscard]] CellRange getRange(const SDL_FRect& bounds)const noexcept
+		{
+			return CellRange{ toCell(bounds.x), toCell(bounds.y), toCell(bounds.x + bounds.w), toCell(bounds.y + bounds.h) };
+		}
+
+		void link(Handle handle, const CellRange& range)
+		{
+			if (range.getCellsCount() > MAX_ITEM_CELLS)
+			{
+				m_Oversized.push_back(handle);
+				return;
+			}
+			for (int y = range.y0; y <= range.y1; ++y)
+			{
+				for (int x = range.x0; x <= range.x1; ++x)
+				{
+					m_Cells[getKey(x, y)].push_back(handle);
+				}
+			}
+		}
+
+		void unlink(Handle handle, const CellRange& range)
+		{
+			if (range.getCellsCount() > MAX_ITEM_CELLS)
+			{
+				eraseFrom(m_Oversized, handle);
+				return;
+			}
+			for (int y = range.y0; y <= range.y1; ++y)
+			{
+				for (int x = range.x0; x <= range.x1; ++x)
+				{
+					const auto it = m_Cells.find(getKey(x, y));
+					if (it == m_Cells.end())
+					{
+						continue;
+					}
+					eraseFrom(it->second, handle);
+					if (it->second.empty())
+					{
+						m_Cells.erase(it);
+					}
+				}
+			}
+		}
+
+		static void eraseFrom(std::vector<Handle>& handles, Handle handle)noexcept
+		{
+			const auto it = std::find(handles.begin(), handles.end(), handle);
+			if (it != handles.end())
+			{
+				*it = handles.back();
+				handles.pop_back();
+			}
+		}
+
+		float m_CellSize;
+		float m_InvCellSize;
+		std::unordered_map<std::uint64_t, std::vector<Handle>> m_Cells;
+		std::vector<Item> m_Items;
+		std::vector<Handle> m_FreeItems;
+		std::vector<Handle> m_Oversized;
+		std::uint32_t m_Stamp = 0;
+		std::size_t m_Size = 0;
+	};
+}
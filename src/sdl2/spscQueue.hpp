@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace sdl2
+{
+	// Bounded single-producer/single-consumer ring buffer.
+	// The storage is allocated once in the constructor; push and pop never allocate or lock.
+	template<class T>
+	class SpscQueue
+	{
+	public:
+		[[nodiscard]] explicit SpscQueue(std::size_t capacity)
+			: m_Items(roundUp(capacity < 2 ? 2 : capacity))
+			, m_Mask(m_Items.size() - 1)
+		{}
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+		template<class U>
+		bool push(U&& item)noexcept
+		{
+			const std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+			if (tail - m_Head.load(std::memory_order_acquire) == m_Items.size())
+			{
+				return false;
+			}
+			m_Items[tail & m_Mask] = std::forward<U>(item);
+			m_Tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool pop(T& item)noexcept
+		{
+			const std::size_t head = m_Head.load(std::memory_order_relaxed);
+			if (head == m_Tail.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+			item = std::move(m_Items[head & m_Mask]);
+			m_Head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		[[nodiscard]] bool isEmpty()const noexcept { return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire); }
+
+		[[nodiscard]] std::size_t size()const noexcept { return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire); }
+
+		[[nodiscard]] std::size_t capacity()const noexcept { return m_Items.size(); }
+
+	private:
+		static constexpr std::size_t CACHE_LINE = 64;
+
+		[[nodiscard]] static std::size_t roundUp(std::size_t value)noexcept
+		{
+			std::size_t result = 1;
+			while (result < value)
+			{
+				result <<= 1;
+			}
+			return result;
+		}
+
+		std::vector<T> m_Items;
+		std::size_t m_Mask;
+		alignas(CACHE_LINE) std::atomic<std::size_t> m_Head{ 0 };
+		alignas(CACHE_LINE) std::atomic<std::size_t> m_Tail{ 0 };
+	};
+}
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "memoryStats.hpp"
+#include "span.hpp"
+#include "trace.hpp"
+
 #include <string>
 #include <optional>
-#include <vector>
 
 #include <SDL_surface.h>
 #include <SDL_version.h>
@@ -31,6 +34,13 @@ namespace sdl2
 
 	using SurfaceView = SDL_Surface*;
 
+	// One rectangle pair of a batched blit.
+	struct SurfaceBlit
+	{
+		SDL_Rect source;
+		SDL_Rect destination;
+	};
+
 	class Surface
 	{
 	public:
@@ -42,45 +52,64 @@ namespace sdl2
 		};
 
 		[[nodiscard]] constexpr Surface() noexcept = default;
-		[[nodiscard]] constexpr explicit Surface(SDL_Surface* surface) noexcept : m_Surface{ surface } {}
+		[[nodiscard]] explicit Surface(SDL_Surface* surface) noexcept
+			: m_Surface{ surface }
+		{
+#ifdef SDL2_ENABLE_MEMORY_STATS
+			if (m_Surface != nullptr)
+			{
+				m_Allocation.track(MemoryResource::SURFACE, memory::getSurfaceBytes(m_Surface));
+			}
+#endif
+		}
 
 		[[nodiscard]] Surface(std::uint32_t flags, int	w, int	h, int	depth, std::uint32_t rmask, std::uint32_t gmask, std::uint32_t bmask, std::uint32_t amask) noexcept
-			: m_Surface{ SDL_CreateRGBSurface(flags, w, h, depth, rmask, gmask, bmask, amask) }
+			: Surface{ SDL_CreateRGBSurface(flags, w, h, depth, rmask, gmask, bmask, amask) }
 		{}
 
 		[[nodiscard]] Surface(std::uint32_t flags, int w, int h, int depth, std::uint32_t format) noexcept
-			: m_Surface{ SDL_CreateRGBSurfaceWithFormat(flags, w, h, depth, format) }
+			: Surface{ SDL_CreateRGBSurfaceWithFormat(flags, w, h, depth, format) }
 		{}
 
 		[[nodiscard]] Surface(void* pixels, int w, int h, int depth, int pitch, int format) noexcept
-			: m_Surface{ SDL_CreateRGBSurfaceWithFormatFrom(pixels, w, h, depth, pitch, format) }
+			: Surface{ SDL_CreateRGBSurfaceWithFormatFrom(pixels, w, h, depth, pitch, format) }
 		{}
 
 #ifdef SDL2_ENABLE_IMG
 		[[nodiscard]] Surface(SDL_RWops* src, int freesrc, const std::string& type) noexcept
-			: m_Surface{ IMG_LoadTyped_RW(src, freesrc, type.c_str()) }
+			: Surface{ IMG_LoadTyped_RW(src, freesrc, type.c_str()) }
 		{}
 
 		[[nodiscard]] Surface(SDL_RWops* src, int freesrc) noexcept
-			: m_Surface{ IMG_Load_RW(src, freesrc) }
+			: Surface{ IMG_Load_RW(src, freesrc) }
 		{}
 
 		[[nodiscard]] Surface(const std::string& filename) noexcept
-			: m_Surface{ IMG_Load(filename.c_str()) }
+			: Surface{ IMG_Load(filename.c_str()) }
 		{}
 #else 
 		[[nodiscard]] Surface(const std::string& filename) noexcept
-			: m_Surface{ SDL_LoadBMP(filename.c_str()) }
+			: Surface{ SDL_LoadBMP(filename.c_str()) }
 		{}
 #endif
 
-		[[nodiscard]] Surface(Surface&& other) noexcept : m_Surface(std::move(other.m_Surface)) { other.m_Surface = nullptr; }
+		[[nodiscard]] Surface(Surface&& other) noexcept
+			: m_Surface(std::move(other.m_Surface))
+#ifdef SDL2_ENABLE_MEMORY_STATS
+			, m_Allocation(std::move(other.m_Allocation))
+#endif
+		{
+			other.m_Surface = nullptr;
+		}
 		Surface& operator=(Surface&& other) noexcept
 		{
 			if (m_Surface != other.m_Surface)
 			{
 				SDL_FreeSurface(m_Surface);
 				m_Surface = other.m_Surface;
+#ifdef SDL2_ENABLE_MEMORY_STATS
+				m_Allocation = std::move(other.m_Allocation);
+#endif
 			}
 			other.m_Surface = nullptr;
 			return *this;
@@ -172,16 +201,19 @@ namespace sdl2
 
 		[[nodiscard]] Surface convert(const SDL_PixelFormat& pixelFormat, std::uint32_t flags = static_cast<std::uint32_t>(SurfaceFlags::SWSURFACE))const noexcept
 		{
+			SDL2_TRACE_SCOPE("surface", "Surface::convert");
 			return Surface{ SDL_ConvertSurface(m_Surface, &pixelFormat, flags) };
 		}
 
 		[[nodiscard]] Surface convert(std::uint32_t format, std::uint32_t flags = static_cast<std::uint32_t>(SurfaceFlags::SWSURFACE))const noexcept
 		{
+			SDL2_TRACE_SCOPE("surface", "Surface::convert");
 			return Surface{ SDL_ConvertSurfaceFormat(m_Surface, format, flags) };
 		}
 
 		bool convert(int width, int height, std::uint32_t src_format, const void* src, int src_pitch, std::uint32_t dst_format, void* dst, int dst_pitch)const noexcept
 		{
+			SDL2_TRACE_SCOPE("surface", "Surface::convertPixels");
 			return SDL_ConvertPixels(width, height, src_format, src, src_pitch, dst_format, dst, dst_pitch) >= 0;
 		}
 
@@ -195,7 +227,8 @@ namespace sdl2
 			return SDL_FillRects(m_Surface, rects, count, color) >= 0;
 		}
 
-		bool fill(const std::vector<SDL_Rect>& rects, std::uint32_t color)noexcept
+		// Takes vectors, arrays and any other contiguous range of rects.
+		bool fill(Span<const SDL_Rect> rects, std::uint32_t color)noexcept
 		{
 			return SDL_FillRects(m_Surface, rects.data(), static_cast<int>(rects.size()), color) >= 0;
 		}
@@ -205,6 +238,48 @@ namespace sdl2
 			return SDL_BlitSurface(source.get(), &sourceRect, destination.get(), &destinationRect) >= 0;
 		}
 
+		// Blits many parts of one source. The surfaces are checked once and every pair is clipped here
+		// before going straight to SDL_LowerBlit, skipping the per call validation of SDL_BlitSurface.
+		static bool blit(Surface& source, Surface& destination, Span<const SurfaceBlit> blits)noexcept
+		{
+			SDL_Surface* src = source.get();
+			SDL_Surface* dst = destination.get();
+			if (src == nullptr || dst == nullptr || src->locked != 0 || dst->locked != 0)
+			{
+				return false;
+			}
+			const SDL_Rect sourceBounds{ 0, 0, src->w, src->h };
+			const SDL_Rect clip = dst->clip_rect;
+			bool success = true;
+			for (const SurfaceBlit& blit : blits)
+			{
+				SDL_Rect from = blit.source;
+				SDL_Rect to{ blit.destination.x, blit.destination.y, from.w, from.h };
+				// Clip against the source surface, moving the destination along.
+				SDL_Rect clipped;
+				if (SDL_IntersectRect(&from, &sourceBounds, &clipped) == SDL_FALSE)
+				{
+					continue;
+				}
+				to.x += clipped.x - from.x;
+				to.y += clipped.y - from.y;
+				to.w = clipped.w;
+				to.h = clipped.h;
+				from = clipped;
+				// Clip against the destination clip rectangle, moving the source along.
+				if (SDL_IntersectRect(&to, &clip, &clipped) == SDL_FALSE)
+				{
+					continue;
+				}
+				from.x += clipped.x - to.x;
+				from.y += clipped.y - to.y;
+				from.w = clipped.w;
+				from.h = clipped.h;
+				success &= SDL_LowerBlit(src, &from, dst, &clipped) >= 0;
+			}
+			return success;
+		}
+
 		static bool upperBlit(Surface& source, const SDL_Rect& sourceRect, Surface& destination, SDL_Rect& destinationRect)noexcept
 		{
 			return SDL_UpperBlit(source.get(), &sourceRect, destination.get(), &destinationRect) >= 0;
@@ -220,6 +295,14 @@ namespace sdl2
 			return SDL_SoftStretch(source.get(), &sourceRect, destination.get(), &destinationRect) >= 0;
 		}
 
+#if SDL_VERSION_ATLEAST(2, 0, 16)
+		// Bilinear variant of stretch(); both surfaces must share a 32-bit format.
+		static bool stretchLinear(Surface& source, const SDL_Rect& sourceRect, Surface& destination, const SDL_Rect& destinationRect)noexcept
+		{
+			return SDL_SoftStretchLinear(source.get(), &sourceRect, destination.get(), &destinationRect) >= 0;
+		}
+#endif
+
 		static bool blitScaled(Surface& source, const SDL_Rect& sourceRect, Surface& destination, SDL_Rect& destinationRect)noexcept
 		{
 			return SDL_BlitScaled(source.get(), &sourceRect, destination.get(), &destinationRect) >= 0;
@@ -264,12 +347,26 @@ namespace sdl2
 		[[nodiscard]] const SurfaceView get()const noexcept { return m_Surface; }
 		[[nodiscard]] SurfaceView get()noexcept { return m_Surface; }
 
+		// Gives up ownership without freeing the surface.
+		[[nodiscard]] SurfaceView release()noexcept
+		{
+			SDL_Surface* surface = m_Surface;
+			m_Surface = nullptr;
+#ifdef SDL2_ENABLE_MEMORY_STATS
+			m_Allocation.untrack();
+#endif
+			return surface;
+		}
+
 #ifdef SDL2_ENABLE_IMG
-		bool savePNG(const std::string& file) { return IMG_SavePNG(m_Surface, file.c_str()); }
-		bool saveJPG(const std::string& file, int quality) { return IMG_SaveJPG(m_Surface, file.c_str(), quality); }
+		bool savePNG(const std::string& file) { return IMG_SavePNG(m_Surface, file.c_str()) == 0; }
+		bool saveJPG(const std::string& file, int quality) { return IMG_SaveJPG(m_Surface, file.c_str(), quality) == 0; }
 #endif
 
 	protected:
 		SDL_Surface* m_Surface = nullptr;
+#ifdef SDL2_ENABLE_MEMORY_STATS
+		memory::Allocation m_Allocation;
+#endif
 	};
 }
\ No newline at end of file
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "surface.hpp"
+
+#include <SDL_assert.h>
+#include <SDL_pixels.h>
+#include <SDL_surface.h>
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sdl2
+{
+	struct SurfacePoolStats
+	{
+		std::uint64_t acquired = 0;
+		std::uint64_t reusedSurfaces = 0; // header and pixels recycled as is
+		std::uint64_t reusedSlabs = 0;    // pixels recycled under a new header
+		std::uint64_t slabAllocations = 0;
+		std::uint64_t slabReleases = 0;
+		std::size_t reservedBytes = 0;
+		std::size_t freeBytes = 0;
+	};
+
+	class SurfacePool;
+
+	// Surface borrowed from a SurfacePool; hands its memory back to the pool when destroyed, so
+	// the pool must outlive it. Draw into the surface freely, but do not move, release or
+	// reassign it: only the surface the pool created is recycled, anything else just frees the slab.
+	class PooledSurface
+	{
+	public:
+		[[nodiscard]] constexpr PooledSurface()noexcept = default;
+
+		PooledSurface(const PooledSurface&) = delete;
+		PooledSurface& operator=(const PooledSurface&) = delete;
+
+		[[nodiscard]] PooledSurface(PooledSurface&& other)noexcept
+			: m_Pool(std::exchange(other.m_Pool, nullptr))
+			, m_Surface(std::move(other.m_Surface))
+			, m_Slab(std::exchange(other.m_Slab, nullptr))
+			, m_SlabSize(other.m_SlabSize)
+		{}
+
+		PooledSurface& operator=(PooledSurface&& other)noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				m_Pool = std::exchange(other.m_Pool, nullptr);
+				m_Surface = std::move(other.m_Surface);
+				m_Slab = std::exchange(other.m_Slab, nullptr);
+				m_SlabSize = other.m_SlabSize;
+			}
+			return *this;
+		}
+
+		~PooledSurface()noexcept { reset(); }
+
+		inline void reset()noexcept;
+
+		[[nodiscard]] bool isValid()const noexcept { return m_Surface.isValid(); }
+
+		[[nodiscard]] sdl2::Surface& get()noexcept { return m_Surface; }
+		[[nodiscard]] const sdl2::Surface& get()const noexcept { return m_Surface; }
+
+		[[nodiscard]] sdl2::Surface* operator->()noexcept { return &m_Surface; }
+		[[nodiscard]] const sdl2::Surface* operator->()const noexcept { return &m_Surface; }
+
+	private:
+		friend class SurfacePool;
+
+		PooledSurface(SurfacePool* pool, SDL_Surface* surface, void* slab, std::size_t slabSize)noexcept
+			: m_Pool(pool)
+			, m_Surface(surface)
+			, m_Slab(slab)
+			, m_SlabSize(slabSize)
+		{}
+
+		SurfacePool* m_Pool = nullptr;
+		sdl2::Surface m_Surface;
+		void* m_Slab = nullptr;
+		std::size_t m_SlabSize = 0;
+	};
+
+	// Recycles pixel memory of temporary surfaces.
+	// Pixels live in 64-byte aligned slabs with 64-byte aligned rows, bucketed by pixel format
+	// and power-of-two size class. A returned surface keeps its SDL_Surface header, so asking
+	// again for the same format and size costs no allocation at all; other sizes of the same
+	// class reuse the slab under a new PREALLOC header. Free memory above maxFreeBytes is
+	// released immediately. Not thread-safe.
+	class SurfacePool
+	{
+	public:
+		static constexpr std::size_t ALIGNMENT = 64;
+
+		[[nodiscard]] explicit SurfacePool(std::size_t maxFreeBytes = 64u << 20)noexcept
+			: m_MaxFreeBytes(maxFreeBytes)
+		{}
+
+		SurfacePool(const SurfacePool&) = delete;
+		SurfacePool& operator=(const SurfacePool&) = delete;
+
+		~SurfacePool()noexcept
+		{
+			SDL_assert(m_Borrowed == 0);
+			trim();
+		}
+
+		// Pixels are left uninitialized. Planar (FOURCC) formats are not supported.
+		// The pool must outlive the returned surface.
+		[[nodiscard]] PooledSurface acquire(int w, int h, std::uint32_t format)
+		{
+			if (w <= 0 || h <= 0 || SDL_ISPIXELFORMAT_FOURCC(format))
+			{
+				return PooledSurface{};
+			}
+			const int pitch = static_cast<int>(align(static_cast<std::size_t>(w) * SDL_BYTESPERPIXEL(format)));
+			const std::size_t slabSize = getSizeClass(static_cast<std::size_t>(pitch) * static_cast<std::size_t>(h));
+			++m_Stats.acquired;
+
+			std::vector<Entry>& bucket = m_Free[getKey(format, slabSize)];
+			const auto exact = std::find_if(bucket.begin(), bucket.end(), [&](const Entry& entry) { return entry.surface != nullptr && entry.surface->w == w && entry.surface->h == h; });
+			if (exact != bucket.end())
+			{
+				Entry entry = *exact;
+				*exact = bucket.back();
+				bucket.pop_back();
+				m_Stats.freeBytes -= slabSize;
+				++m_Stats.reusedSurfaces;
+				resetState(entry.surface);
+				++m_Borrowed;
+				return PooledSurface{ this, entry.surface, entry.slab, slabSize };
+			}
+
+			void* slab = nullptr;
+			if (!bucket.empty())
+			{
+				const Entry entry = bucket.back();
+				bucket.pop_back();
+				SDL_FreeSurface(entry.surface);
+				m_Stats.freeBytes -= slabSize;
+				++m_Stats.reusedSlabs;
+				slab = entry.slab;
+			}
+			else
+			{
+				slab = ::operator new(slabSize, std::align_val_t{ ALIGNMENT }, std::nothrow);
+				if (slab == nullptr)
+				{
+					return PooledSurface{};
+				}
+				++m_Stats.slabAllocations;
+				m_Stats.reservedBytes += slabSize;
+			}
+
+			SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(slab, w, h, static_cast<int>(SDL_BITSPERPIXEL(format)), pitch, format);
+			if (surface == nullptr)
+			{
+				releaseSlab(slab, slabSize);
+				return PooledSurface{};
+			}
+			surface->flags |= SDL_SIMD_ALIGNED;
+			++m_Borrowed;
+			return PooledSurface{ this, surface, slab, slabSize };
+		}
+
+		// Releases every free slab.
+		void trim()noexcept
+		{
+			for (auto& [key, bucket] : m_Free)
+			{
+				for (const Entry& entry : bucket)
+				{
+					SDL_FreeSurface(entry.surface);
+					releaseSlab(entry.slab, getSlabSize(key));
+				}
+			}
+			m_Free.clear();
+			m_Stats.freeBytes = 0;
+		}
+
+		[[nodiscard]] const SurfacePoolStats& getStats()const noexcept { return m_Stats; }
+
+	private:
+		friend class PooledSurface;
+
+		struct Entry
+		{
+			SDL_Surface* surface = nullptr;
+			void* slab = nullptr;
+		};
+
+		static constexpr std::size_t MIN_SIZE_CLASS = 4096;
+
+		[[nodiscard]] static constexpr std::size_t align(std::size_t bytes)noexcept { return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+		[[nodiscard]] static constexpr std::size_t getSizeClass(std::size_t bytes)noexcept
+		{
+			std::size_t size = MIN_SIZE_CLASS;
+			while (size < bytes)
+			{
+				size <<= 1;
+			}
+			return size;
+		}
+
+		[[nodiscard]] static constexpr std::uint64_t getKey(std::uint32_t format, std::size_t slabSize)noexcept
+		{
+			return (static_cast<std::uint64_t>(format) << 32) | (slabSize / MIN_SIZE_CLASS);
+		}
+
+		[[nodiscard]] static constexpr std::size_t getSlabSize(std::uint64_t key)noexcept { return (key & 0xFFFFFFFFu) * MIN_SIZE_CLASS; }
+
+		// Puts back what earlier users may have changed so a recycled surface looks freshly created.
+		static void resetState(SDL_Surface* surface)noexcept
+		{
+			SDL_SetClipRect(surface, nullptr);
+			SDL_SetColorKey(surface, 0, 0);
+			SDL_SetSurfaceRLE(surface, 0);
+			SDL_SetSurfaceColorMod(surface, 255, 255, 255);
+			SDL_SetSurfaceAlphaMod(surface, 255);
+			SDL_SetSurfaceBlendMode(surface, SDL_ISPIXELFORMAT_ALPHA(surface->format->format) ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+			surface->userdata = nullptr;
+		}
+
+		void releaseSlab(void* slab, std::size_t slabSize)noexcept
+		{
+			::operator delete(slab, std::align_val_t{ ALIGNMENT });
+			++m_Stats.slabReleases;
+			m_Stats.reservedBytes -= slabSize;
+		}
+
+		// Takes back a borrowed slab; surface is null when the borrower no longer holds the header the pool created.
+		void recycle(SDL_Surface* surface, void* slab, std::size_t slabSize)noexcept
+		{
+			--m_Borrowed;
+			if (surface == nullptr)
+			{
+				releaseSlab(slab, slabSize);
+				return;
+			}
+			if (m_Stats.freeBytes + slabSize > m_MaxFreeBytes)
+			{
+				SDL_FreeSurface(surface);
+				releaseSlab(slab, slabSize);
+				return;
+			}
+			try
+			{
+				m_Free[getKey(surface->format->format, slabSize)].push_back(Entry{ surface, slab });
+				m_Stats.freeBytes += slabSize;
+			}
+			catch (...)
+			{
+				SDL_FreeSurface(surface);
+				releaseSlab(slab, slabSize);
+			}
+		}
+
+		std::unordered_map<std::uint64_t, std::vector<Entry>> m_Free;
+		std::size_t m_MaxFreeBytes;
+		SurfacePoolStats m_Stats;
+		std::size_t m_Borrowed = 0;
+	};
+
+	inline void PooledSurface::reset()noexcept
+	{
+		if (m_Pool != nullptr)
+		{
+			const bool isOwn = m_Surface.isValid() && m_Surface.getPixels() == m_Slab;
+			SDL_assert(isOwn);
+			m_Pool->recycle(isOwn ? m_Surface.release() : nullptr, m_Slab, m_SlabSize);
+		}
+		m_Surface = sdl2::Surface{};
+		m_Pool = nullptr;
+		m_Slab = nullptr;
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "memoryStats.hpp"
 #include "surface.hpp"
 #include "renderer.hpp"
 #ifdef SDL2_ENABLE_IMG
@@ -24,21 +25,33 @@ namespace sdl2
 		constexpr Texture()noexcept = default;
 
 		Texture(RendererView renderer, SurfaceView surface)noexcept
-			: m_Texture(SDL_CreateTextureFromSurface(renderer, surface))
-		{}
+		{
+			SDL2_TRACE_SCOPE("render", "Texture::create");
+			m_Texture = SDL_CreateTextureFromSurface(renderer, surface);
+			track();
+		}
 
 		Texture(RendererView renderer, sdl2::Surface& surface)noexcept
-			: m_Texture(SDL_CreateTextureFromSurface(renderer, surface.get()))
-		{}
+		{
+			SDL2_TRACE_SCOPE("render", "Texture::create");
+			m_Texture = SDL_CreateTextureFromSurface(renderer, surface.get());
+			track();
+		}
 
 		Texture(RendererView renderer, std::uint32_t format, int access, int w, int h)
-			: m_Texture(SDL_CreateTexture(renderer, format, access, w, h))
-		{}
+		{
+			SDL2_TRACE_SCOPE("render", "Texture::create");
+			m_Texture = SDL_CreateTexture(renderer, format, access, w, h);
+			track();
+		}
 
 #ifdef SDL2_ENABLE_IMG
 		Texture(RendererView renderer, const std::string& file)noexcept
-			: m_Texture(IMG_LoadTexture(renderer, file.c_str()))
-		{}
+		{
+			SDL2_TRACE_SCOPE("load", "Texture::load");
+			m_Texture = IMG_LoadTexture(renderer, file.c_str());
+			track();
+		}
 #endif
 		~Texture()noexcept
 		{
@@ -49,7 +62,14 @@ namespace sdl2
 		}
 
 		Texture(Texture&) = delete;
-		Texture(Texture&& t) noexcept : m_Texture(t.m_Texture) { t.m_Texture = nullptr; };
+		Texture(Texture&& t) noexcept
+			: m_Texture(t.m_Texture)
+#ifdef SDL2_ENABLE_MEMORY_STATS
+			, m_Allocation(std::move(t.m_Allocation))
+#endif
+		{
+			t.m_Texture = nullptr;
+		}
 
 		Texture& operator=(Texture&) = delete;
 		Texture& operator=(Texture&& t) noexcept 
@@ -58,6 +78,9 @@ namespace sdl2
 			{
 				SDL_DestroyTexture(m_Texture);
 				m_Texture = t.m_Texture;
+#ifdef SDL2_ENABLE_MEMORY_STATS
+				m_Allocation = std::move(t.m_Allocation);
+#endif
 			}
 			t.m_Texture = nullptr;
 			return *this;
@@ -186,7 +209,22 @@ namespace sdl2
 		bool glUnbind() { return SDL_GL_UnbindTexture(m_Texture) == 0; }
 
 	private:
+		// Counts the texture in the memory stats once it has been created.
+		void track()noexcept
+		{
+#ifdef SDL2_ENABLE_MEMORY_STATS
+			if (m_Texture != nullptr)
+			{
+				const Attributes attributes = getAttributes();
+				m_Allocation.track(MemoryResource::TEXTURE, memory::getTextureBytes(attributes.format, attributes.w, attributes.h));
+			}
+#endif
+		}
+
 		SDL_Texture* m_Texture = nullptr;
+#ifdef SDL2_ENABLE_MEMORY_STATS
+		memory::Allocation m_Allocation;
+#endif
 	};
 
 	using SharedTexture = std::shared_ptr<sdl2::Texture>;
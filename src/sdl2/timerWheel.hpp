@@ -0,0 +1,370 @@
+#pragma once
+
+#include "events.hpp"
+
+#include <SDL_events.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace sdl2
+{
+	struct TimerHandle
+	{
+		std::uint32_t index = 0xFFFFFFFFu;
+		std::uint32_t generation = 0;
+	};
+
+	// Hierarchical timer wheel for large numbers of gameplay timers, ticked from the main loop.
+	// Four levels of 256 slots cover 2^32 ticks; timers further away are parked in the last level
+	// and re-filed as the wheel turns. Nodes live in a pool with a free list and are linked into
+	// their slot, so adding and cancelling are O(1) and allocation free once the pool has grown.
+	// Timers due on the same tick fire in deadline order, ties in the order they were added,
+	// which keeps replays deterministic. Handles carry a generation, so a stale handle never
+	// cancels a newer timer that reuses the node.
+	class TimerWheel
+	{
+	public:
+		using Callback = void(*)(void* userData);
+
+		static constexpr std::size_t SLOTS = 256;
+		static constexpr std::size_t LEVELS = 4;
+
+		[[nodiscard]] explicit TimerWheel(std::uint32_t ticksPerSecond = 1000, std::size_t reserve = 1024)
+			: m_Frequency(SDL_GetPerformanceFrequency())
+			, m_TicksPerSecond(std::max<std::uint32_t>(ticksPerSecond, 1))
+			, m_Start(SDL_GetPerformanceCounter())
+		{
+			m_Heads.fill(NONE);
+			m_Nodes.reserve(reserve);
+		}
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+		// Fires callback after delay, then every interval if it is not zero. The delay is rounded
+		// up to whole ticks, is at least one tick and counts from the last update() or advance().
+		TimerHandle add(std::chrono::microseconds delay, Callback callback, void* userData = nullptr, std::chrono::microseconds interval = std::chrono::microseconds{ 0 })
+		{
+			std::uint32_t index = 0;
+			if (m_FreeNode != NONE)
+			{
+				index = m_FreeNode;
+				m_FreeNode = m_Nodes[index].next;
+			}
+			else
+			{
+				index = static_cast<std::uint32_t>(m_Nodes.size());
+				m_Nodes.emplace_back();
+			}
+			Node& node = m_Nodes[index];
+			node.callback = callback;
+			node.userData = userData;
+			node.deadline = m_Tick + std::max<std::uint64_t>(toTicks(delay), 1);
+			node.interval = interval.count() > 0 ? std::max<std::uint64_t>(toTicks(interval), 1) : 0;
+			node.sequence = m_Sequence++;
+			node.isActive = true;
+			link(index, m_Tick + 1);
+			++m_Size;
+			return TimerHandle{ index, node.generation };
+		}
+
+		bool cancel(TimerHandle handle)noexcept
+		{
+			if (!isActive(handle))
+			{
+				return false;
+			}
+			Node& node = m_Nodes[handle.index];
+			if (node.slot != NONE)
+			{
+				unlink(handle.index);
+			}
+			// A timer cancelled from inside its own callback is released once the callback returns.
+			node.isActive = false;
+			if (handle.index != m_Firing)
+			{
+				release(handle.index);
+			}
+			return true;
+		}
+
+		[[nodiscard]] bool isActive(TimerHandle handle)const noexcept
+		{
+			return handle.index < m_Nodes.size() && m_Nodes[handle.index].generation == handle.generation && m_Nodes[handle.index].isActive;
+		}
+
+		// Advances to the current performance counter time; returns how many timers fired.
+		std::size_t update()
+		{
+			const std::uint64_t elapsed = SDL_GetPerformanceCounter() - m_Start;
+			const std::uint64_t target = elapsed / m_Frequency * m_TicksPerSecond + elapsed % m_Frequency * m_TicksPerSecond / m_Frequency;
+			return target > m_Tick ? advance(target - m_Tick) : 0;
+		}
+
+		// Advances by a number of ticks regardless of the clock, e.g. for fixed step simulations.
+		std::size_t advance(std::uint64_t ticks)
+		{
+			std::size_t fired = 0;
+			const std::uint64_t target = m_Tick + ticks;
+			while (m_Tick < target)
+			{
+				if (m_Size == 0)
+				{
+					m_Tick = target;
+					break;
+				}
+				++m_Tick;
+				if ((m_Tick & MASK) == 0)
+				{
+					cascade();
+				}
+				fired += fire(static_cast<std::uint32_t>(m_Tick & MASK));
+			}
+			return fired;
+		}
+
+		// Time until the next timer is due, std::nullopt when there is none.
+		[[nodiscard]] std::optional<std::chrono::microseconds> getTimeout()const
+		{
+			if (m_Size == 0)
+			{
+				return std::nullopt;
+			}
+			// Within a level deadlines grow with the distance from the current slot, which itself
+			// holds the timers that wrapped around. Across levels they do not: a timer filed in an
+			// upper level slot that is about to cascade can be due before one in a lower level, so
+			// the earliest slot of every level is checked.
+			std::optional<std::uint64_t> earliest;
+			for (std::size_t level = 0; level < LEVELS; ++level)
+			{
+				const unsigned shift = static_cast<unsigned>(level) * BITS;
+				for (std::uint64_t step = 1; step <= SLOTS; ++step)
+				{
+					const std::uint32_t head = m_Heads[level * SLOTS + static_cast<std::uint32_t>(((m_Tick >> shift) + step) & MASK)];
+					if (head == NONE)
+					{
+						continue;
+					}
+					for (std::uint32_t index = head; index != NONE; index = m_Nodes[index].next)
+					{
+						earliest = std::min(earliest.value_or(m_Nodes[index].deadline), m_Nodes[index].deadline);
+					}
+					break;
+				}
+			}
+			if (!earliest)
+			{
+				return std::nullopt;
+			}
+			return toDuration(*earliest) - toDuration(getElapsedTicks());
+		}
+
+		[[nodiscard]] std::size_t getSize()const noexcept { return m_Size; }
+
+		[[nodiscard]] std::uint64_t getTick()const noexcept { return m_Tick; }
+
+		[[nodiscard]] std::uint32_t getTicksPerSecond()const noexcept { return m_TicksPerSecond; }
+
+		[[nodiscard]] std::size_t getPoolSize()const noexcept { return m_Nodes.size(); }
+
+	private:
+		static constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+		static constexpr unsigned BITS = 8;
+		static constexpr std::uint64_t MASK = SLOTS - 1;
+
+		struct Node
+		{
+			Callback callback = nullptr;
+			void* userData = nullptr;
+			std::uint64_t deadline = 0;
+			std::uint64_t interval = 0;
+			std::uint64_t sequence = 0;
+			std::uint32_t generation = 0;
+			std::uint32_t prev = NONE;
+			std::uint32_t next = NONE;
+			std::uint32_t slot = NONE;
+			bool isActive = false;
+		};
+
+		[[nodiscard]] std::uint64_t toTicks(std::chrono::microseconds duration)const noexcept
+		{
+			const auto us = static_cast<std::uint64_t>(duration.count());
+			return (us * m_TicksPerSecond + 999999) / 1000000;
+		}
+
+		[[nodiscard]] std::chrono::microseconds toDuration(std::uint64_t ticks)const noexcept
+		{
+			return std::chrono::microseconds{ static_cast<std::chrono::microseconds::rep>(ticks * 1000000 / m_TicksPerSecond) };
+		}
+
+		[[nodiscard]] std::uint64_t getElapsedTicks()const noexcept
+		{
+			const std::uint64_t elapsed = SDL_GetPerformanceCounter() - m_Start;
+			return std::max(m_Tick, elapsed / m_Frequency * m_TicksPerSecond + elapsed % m_Frequency * m_TicksPerSecond / m_Frequency);
+		}
+
+		// Timers due before earliest are filed for earliest.
+		void link(std::uint32_t index, std::uint64_t earliest)noexcept
+		{
+			Node& node = m_Nodes[index];
+			const std::uint64_t deadline = std::max(node.deadline, earliest);
+			const std::uint64_t delta = deadline - m_Tick;
+			std::size_t level = 0;
+			while (level + 1 < LEVELS && delta >= (std::uint64_t{ 1 } << (BITS * (level + 1))))
+			{
+				++level;
+			}
+			// Beyond the range of the wheel: park in the furthest slot of the last level.
+			const std::uint64_t filed = std::min(deadline, m_Tick + (std::uint64_t{ 1 } << (BITS * LEVELS)) - (std::uint64_t{ 1 } << (BITS * (LEVELS - 1))));
+			const auto slot = static_cast<std::uint32_t>(level * SLOTS + ((filed >> (BITS * level)) & MASK));
+			node.slot = slot;
+			node.prev = NONE;
+			node.next = m_Heads[slot];
+			if (node.next != NONE)
+			{
+				m_Nodes[node.next].prev = index;
+			}
+			m_Heads[slot] = index;
+		}
+
+		void unlink(std::uint32_t index)noexcept
+		{
+			Node& node = m_Nodes[index];
+			if (node.prev != NONE)
+			{
+				m_Nodes[node.prev].next = node.next;
+			}
+			else
+			{
+				m_Heads[node.slot] = node.next;
+			}
+			if (node.next != NONE)
+			{
+				m_Nodes[node.next].prev = node.prev;
+			}
+			node.prev = NONE;
+			node.next = NONE;
+			node.slot = NONE;
+		}
+
+		void release(std::uint32_t index)noexcept
+		{
+			Node& node = m_Nodes[index];
+			node.isActive = false;
+			++node.generation;
+			node.callback = nullptr;
+			node.userData = nullptr;
+			node.next = m_FreeNode;
+			m_FreeNode = index;
+			--m_Size;
+		}
+
+		// Re-files the timers of the upper level slots that the wheel has just reached.
+		void cascade()
+		{
+			for (std::size_t level = 1; level < LEVELS; ++level)
+			{
+				const unsigned shift = static_cast<unsigned>(level) * BITS;
+				const auto slot = static_cast<std::uint32_t>(level * SLOTS + ((m_Tick >> shift) & MASK));
+				std::uint32_t index = m_Heads[slot];
+				m_Heads[slot] = NONE;
+				while (index != NONE)
+				{
+					const std::uint32_t next = m_Nodes[index].next;
+					// The current tick is still to be fired, so timers due now go straight to it.
+					link(index, m_Tick);
+					index = next;
+				}
+				if (((m_Tick >> shift) & MASK) != 0)
+				{
+					break;
+				}
+			}
+		}
+
+		std::size_t fire(std::size_t slot)
+		{
+			m_Due.clear();
+			for (std::uint32_t index = m_Heads[slot]; index != NONE; index = m_Nodes[index].next)
+			{
+				m_Due.push_back(TimerHandle{ index, m_Nodes[index].generation });
+			}
+			if (m_Due.empty())
+			{
+				return 0;
+			}
+			for (const TimerHandle& due : m_Due)
+			{
+				unlink(due.index);
+			}
+			std::sort(m_Due.begin(), m_Due.end(), [this](const TimerHandle& a, const TimerHandle& b)
+			{
+				const Node& first = m_Nodes[a.index];
+				const Node& second = m_Nodes[b.index];
+				return first.deadline != second.deadline ? first.deadline < second.deadline : first.sequence < second.sequence;
+			});
+			std::size_t fired = 0;
+			for (std::size_t i = 0; i < m_Due.size(); ++i)
+			{
+				// An earlier callback of this tick may have cancelled it, and a new timer may even
+				// have taken over the node.
+				if (!isActive(m_Due[i]))
+				{
+					continue;
+				}
+				const std::uint32_t index = m_Due[i].index;
+				m_Firing = index;
+				m_Nodes[index].callback(m_Nodes[index].userData);
+				m_Firing = NONE;
+				++fired;
+				Node& node = m_Nodes[index];
+				if (node.isActive && node.interval != 0)
+				{
+					node.deadline += node.interval;
+					node.sequence = m_Sequence++;
+					link(index, m_Tick + 1);
+				}
+				else
+				{
+					release(index);
+				}
+			}
+			return fired;
+		}
+
+		std::uint64_t m_Frequency;
+		std::uint32_t m_TicksPerSecond;
+		std::uint64_t m_Start;
+		std::uint64_t m_Tick = 0;
+		std::uint64_t m_Sequence = 0;
+		std::array<std::uint32_t, SLOTS * LEVELS> m_Heads;
+		std::vector<Node> m_Nodes;
+		std::vector<TimerHandle> m_Due;
+		std::uint32_t m_FreeNode = NONE;
+		std::uint32_t m_Firing = NONE;
+		std::size_t m_Size = 0;
+	};
+
+	namespace events
+	{
+		// Waits for an event no longer than until the next timer of the wheel is due.
+		inline bool wait(SDL_Event& event, const TimerWheel& timers)
+		{
+			const std::optional<std::chrono::microseconds> timeout = timers.getTimeout();
+			if (!timeout)
+			{
+				return wait(event);
+			}
+			if (timeout->count() <= 0)
+			{
+				return poll(event);
+			}
+			return wait(event, std::chrono::ceil<std::chrono::milliseconds>(*timeout));
+		}
+	}
+}
@@ -0,0 +1,306 @@
+#pragma once
+
+// Scoped tracing of the expensive wrapper calls, exported as Chrome trace event JSON that
+// chrome://tracing and ui.perfetto.dev open directly. Define SDL2_ENABLE_TRACE to build it in;
+// without it SDL2_TRACE_SCOPE expands to nothing and the trace functions do nothing.
+//
+//   sdl2::trace::start();
+//   { SDL2_TRACE_SCOPE("game", "update"); ... }
+//   sdl2::trace::save("frame.json");
+
+#ifdef SDL2_ENABLE_TRACE
+	#include <SDL_rwops.h>
+	#include <SDL_timer.h>
+	#include <algorithm>
+	#include <atomic>
+	#include <cstdio>
+	#include <memory>
+	#include <mutex>
+	#include <new>
+	#include <vector>
+#endif
+#include <cstdint>
+#include <string>
+
+#define SDL2_TRACE_CONCAT_IMPL(a, b) a##b
+#define SDL2_TRACE_CONCAT(a, b) SDL2_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef SDL2_ENABLE_TRACE
+	// Category and name must be string literals or otherwise outlive the trace.
+	#define SDL2_TRACE_SCOPE(category, name) const ::sdl2::trace::Scope SDL2_TRACE_CONCAT(sdl2TraceScope, __LINE__){ category, name }
+#else
+	#define SDL2_TRACE_SCOPE(category, name) static_cast<void>(0)
+#endif
+
+namespace sdl2::trace
+{
+#ifdef SDL2_ENABLE_TRACE
+	namespace detail
+	{
+		struct Event
+		{
+			const char* category;
+			const char* name;
+			std::uint64_t start;
+			std::uint64_t end;
+		};
+
+		// Written only by its own thread. Events are published with a release store of the count,
+		// so save() can read everything below it while the thread keeps tracing.
+		struct ThreadBuffer
+		{
+			std::unique_ptr<Event[]> events;
+			std::size_t capacity = 0;
+			std::atomic<std::size_t> count{ 0 };
+			std::atomic<std::uint32_t> session{ 0 };
+			std::atomic<std::uint64_t> dropped{ 0 };
+			std::uint32_t threadId = 0;
+			std::string threadName;
+		};
+
+		struct State
+		{
+			std::atomic<bool> isEnabled{ false };
+			std::atomic<std::uint32_t> session{ 0 };
+			std::atomic<std::size_t> capacity{ 1 << 16 };
+			std::uint64_t origin = 0;
+			std::mutex mutex;
+			std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+		};
+
+		[[nodiscard]] inline State& getState()noexcept
+		{
+			static State state;
+			return state;
+		}
+
+		// Registered on first use; the registry keeps the buffer alive after the thread exits.
+		[[nodiscard]] inline ThreadBuffer* getThreadBuffer()noexcept
+		{
+			thread_local ThreadBuffer* local = nullptr;
+			if (local == nullptr)
+			{
+				try
+				{
+					State& state = getState();
+					auto buffer = std::make_shared<ThreadBuffer>();
+					std::lock_guard lock{ state.mutex };
+					buffer->threadId = static_cast<std::uint32_t>(state.buffers.size() + 1);
+					state.buffers.push_back(buffer);
+					local = buffer.get();
+				}
+				catch (...)
+				{
+					return nullptr;
+				}
+			}
+			return local;
+		}
+
+		inline void record(const char* category, const char* name, std::uint64_t start, std::uint64_t end)noexcept
+		{
+			ThreadBuffer* buffer = getThreadBuffer();
+			if (buffer == nullptr)
+			{
+				return;
+			}
+			State& state = getState();
+			const std::uint32_t session = state.session.load(std::memory_order_acquire);
+			std::size_t count = buffer->count.load(std::memory_order_relaxed);
+			// The first event of a session starts the buffer over.
+			if (buffer->session.load(std::memory_order_relaxed) != session)
+			{
+				count = 0;
+				buffer->count.store(0, std::memory_order_relaxed);
+				buffer->dropped.store(0, std::memory_order_relaxed);
+				buffer->session.store(session, std::memory_order_release);
+			}
+			if (buffer->events == nullptr)
+			{
+				const std::size_t capacity = state.capacity.load(std::memory_order_relaxed);
+				buffer->events.reset(new (std::nothrow) Event[capacity]);
+				buffer->capacity = buffer->events != nullptr ? capacity : 0;
+			}
+			if (count >= buffer->capacity)
+			{
+				buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			buffer->events[count] = Event{ category, name, start, end };
+			buffer->count.store(count + 1, std::memory_order_release);
+		}
+
+		inline void appendEscaped(std::string& out, const char* text)
+		{
+			for (; *text != '\0'; ++text)
+			{
+				const char ch = *text;
+				if (ch == '"' || ch == '\\')
+				{
+					out += '\\';
+					out += ch;
+				}
+				else if (static_cast<unsigned char>(ch) < 0x20)
+				{
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(ch));
+					out += escaped;
+				}
+				else
+				{
+					out += ch;
+				}
+			}
+		}
+	}
+
+	// Records the time from construction to destruction as one complete event. Costs two
+	// performance counter reads and a store into the thread's buffer; nothing when not started.
+	class Scope
+	{
+	public:
+		Scope(const char* category, const char* name)noexcept
+			: m_Category(category)
+			, m_Name(name)
+			, m_Start(detail::getState().isEnabled.load(std::memory_order_relaxed) ? SDL_GetPerformanceCounter() : 0)
+		{}
+
+		~Scope()
+		{
+			if (m_Start != 0 && detail::getState().isEnabled.load(std::memory_order_relaxed))
+			{
+				detail::record(m_Category, m_Name, m_Start, SDL_GetPerformanceCounter());
+			}
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		const char* m_Category;
+		const char* m_Name;
+		std::uint64_t m_Start;
+	};
+
+	// Events kept per thread and session; later ones are counted as dropped. Takes effect for
+	// threads that have not traced yet.
+	inline void setCapacity(std::size_t eventsPerThread)noexcept { detail::getState().capacity.store(eventsPerThread, std::memory_order_relaxed); }
+
+	// Starts a new session and discards the events of the previous one. start(), stop() and
+	// save() are meant to be called from one controlling thread.
+	inline void start()noexcept
+	{
+		detail::State& state = detail::getState();
+		state.origin = SDL_GetPerformanceCounter();
+		state.session.fetch_add(1, std::memory_order_acq_rel);
+		state.isEnabled.store(true, std::memory_order_release);
+	}
+
+	inline void stop()noexcept { detail::getState().isEnabled.store(false, std::memory_order_release); }
+
+	[[nodiscard]] inline bool isEnabled()noexcept { return detail::getState().isEnabled.load(std::memory_order_relaxed); }
+
+	// Shown in the trace viewer instead of the thread number, e.g. "audio".
+	inline void setThreadName(const char* name)
+	{
+		if (detail::ThreadBuffer* buffer = detail::getThreadBuffer(); buffer != nullptr)
+		{
+			std::lock_guard lock{ detail::getState().mutex };
+			buffer->threadName = name;
+		}
+	}
+
+	[[nodiscard]] inline std::uint64_t getDroppedCount()
+	{
+		detail::State& state = detail::getState();
+		const std::uint32_t session = state.session.load(std::memory_order_acquire);
+		std::lock_guard lock{ state.mutex };
+		std::uint64_t dropped = 0;
+		for (const auto& buffer : state.buffers)
+		{
+			if (buffer->session.load(std::memory_order_acquire) == session)
+			{
+				dropped += buffer->dropped.load(std::memory_order_relaxed);
+			}
+		}
+		return dropped;
+	}
+
+	// Chrome trace event JSON of the current session; threads may keep tracing meanwhile.
+	[[nodiscard]] inline std::string toJson()
+	{
+		detail::State& state = detail::getState();
+		const std::uint32_t session = state.session.load(std::memory_order_acquire);
+		const double toMicroseconds = 1000000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+		std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		bool isFirst = true;
+		char number[64];
+		std::lock_guard lock{ state.mutex };
+		for (const auto& buffer : state.buffers)
+		{
+			if (!buffer->threadName.empty())
+			{
+				std::snprintf(number, sizeof(number), "%u", buffer->threadId);
+				json += isFirst ? "" : ",";
+				json += "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+				json += number;
+				json += ",\"args\":{\"name\":\"";
+				detail::appendEscaped(json, buffer->threadName.c_str());
+				json += "\"}}";
+				isFirst = false;
+			}
+			if (buffer->session.load(std::memory_order_acquire) != session)
+			{
+				continue;
+			}
+			const std::size_t count = buffer->count.load(std::memory_order_acquire);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const detail::Event& event = buffer->events[i];
+				const double start = static_cast<double>(event.start - std::min(event.start, state.origin)) * toMicroseconds;
+				const double duration = static_cast<double>(event.end - event.start) * toMicroseconds;
+				json += isFirst ? "" : ",";
+				json += "\n{\"name\":\"";
+				detail::appendEscaped(json, event.name);
+				json += "\",\"cat\":\"";
+				detail::appendEscaped(json, event.category);
+				std::snprintf(number, sizeof(number), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u", buffer->threadId);
+				json += number;
+				std::snprintf(number, sizeof(number), ",\"ts\":%.3f,\"dur\":%.3f}", start, duration);
+				json += number;
+				isFirst = false;
+			}
+		}
+		json += "\n]}\n";
+		return json;
+	}
+
+	inline bool save(const std::string& file)
+	{
+		const std::string json = toJson();
+		SDL_RWops* rw = SDL_RWFromFile(file.c_str(), "wb");
+		if (rw == nullptr)
+		{
+			return false;
+		}
+		const bool isWritten = SDL_RWwrite(rw, json.data(), 1, json.size()) == json.size();
+		return SDL_RWclose(rw) == 0 && isWritten;
+	}
+#else
+	inline void setCapacity(std::size_t)noexcept {}
+
+	inline void start()noexcept {}
+
+	inline void stop()noexcept {}
+
+	[[nodiscard]] inline bool isEnabled()noexcept { return false; }
+
+	inline void setThreadName(const char*)noexcept {}
+
+	[[nodiscard]] inline std::uint64_t getDroppedCount()noexcept { return 0; }
+
+	[[nodiscard]] inline std::string toJson() { return {}; }
+
+	inline bool save(const std::string&)noexcept { return false; }
+#endif
+}
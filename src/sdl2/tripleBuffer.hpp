@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace sdl2
+{
+	// Lock-free single-writer/single-reader latest-value channel.
+	// The writer fills getWriteBuffer() and publish()es it; the reader calls update() and reads
+	// getReadBuffer(). Neither side ever waits or allocates, and the reader always sees the most
+	// recent complete value; values published in between are skipped.
+	template<class T>
+	class TripleBuffer
+	{
+	public:
+		[[nodiscard]] TripleBuffer() = default;
+
+		[[nodiscard]] explicit TripleBuffer(const T& initial)
+			: m_Buffers{ initial, initial, initial }
+		{}
+
+		TripleBuffer(const TripleBuffer&) = delete;
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		[[nodiscard]] T& getWriteBuffer()noexcept { return m_Buffers[m_Write]; }
+
+		// Hands the write buffer over to the reader and takes the spare one in exchange.
+		void publish()noexcept
+		{
+			const std::uint8_t previous = m_Middle.exchange(static_cast<std::uint8_t>(m_Write | FRESH), std::memory_order_acq_rel);
+			m_Write = previous & INDEX;
+		}
+
+		// Like publish(), but only while the reader has not picked up the last published value yet,
+		// which is then handed back as the write buffer. Returns false, publishing nothing, once the
+		// reader has taken it. Lets the writer fold what the skipped value carried into the new one.
+		bool replace()noexcept
+		{
+			std::uint8_t previous = m_Middle.load(std::memory_order_relaxed);
+			// Only the writer sets FRESH, so the exchange can only fail because the reader took it.
+			if ((previous & FRESH) == 0 || !m_Middle.compare_exchange_strong(previous, static_cast<std::uint8_t>(m_Write | FRESH), std::memory_order_acq_rel, std::memory_order_relaxed))
+			{
+				return false;
+			}
+			m_Write = previous & INDEX;
+			return true;
+		}
+
+		// Picks up the latest published value; returns whether there was a new one.
+		bool update()noexcept
+		{
+			if ((m_Middle.load(std::memory_order_relaxed) & FRESH) == 0)
+			{
+				return false;
+			}
+			const std::uint8_t previous = m_Middle.exchange(m_Read, std::memory_order_acq_rel);
+			m_Read = previous & INDEX;
+			return true;
+		}
+
+		[[nodiscard]] const T& getReadBuffer()const noexcept { return m_Buffers[m_Read]; }
+
+	private:
+		static constexpr std::uint8_t INDEX = 0x3;
+		static constexpr std::uint8_t FRESH = 0x4;
+		static constexpr std::size_t CACHE_LINE = 64;
+
+		T m_Buffers[3]{};
+		alignas(CACHE_LINE) std::atomic<std::uint8_t> m_Middle{ 1 };
+		alignas(CACHE_LINE) std::uint8_t m_Write = 0;
+		alignas(CACHE_LINE) std::uint8_t m_Read = 2;
+	};
+}
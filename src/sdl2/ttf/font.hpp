@@ -1,8 +1,11 @@
 #pragma once
 
 #include "../surface.hpp"
+#include "utf8.hpp"
+
 #include <SDL_ttf.h>
 #include <utility>
+#include <string>
 #include <string_view>
 #include <optional>
 
@@ -95,34 +98,53 @@ namespace sdl2::ttf
 		[[nodiscard]] std::string_view getFaceFamilyName()const noexcept { return TTF_FontFaceFamilyName(m_Font); }
 		[[nodiscard]] std::string_view getFaceStyleName()const noexcept { return TTF_FontFaceStyleName(m_Font); }
 
-		[[nodiscard]] bool isGlyphProvided(std::uint16_t ch)const noexcept { return TTF_GlyphIsProvided(m_Font, ch) > 0; }
-		[[nodiscard]] int getGlyphIndex(std::uint16_t ch)const noexcept { return TTF_GlyphIsProvided(m_Font, ch); }
+		[[nodiscard]] bool isGlyphProvided(char32_t ch)const noexcept { return glyphIsProvided(ch) > 0; }
+		[[nodiscard]] int getGlyphIndex(char32_t ch)const noexcept { return glyphIsProvided(ch); }
 
-		bool queryGlyphMetrics(std::uint16_t ch, int& minx, int& maxx, int& miny, int& maxy, int& advance)noexcept { return TTF_GlyphMetrics(m_Font, ch, &minx, &maxx, &miny, &maxy, &advance) == 0; }
+		bool queryGlyphMetrics(char32_t ch, int& minx, int& maxx, int& miny, int& maxy, int& advance)noexcept
+		{
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			return TTF_GlyphMetrics32(m_Font, ch, &minx, &maxx, &miny, &maxy, &advance) == 0;
+#else
+			return ch <= 0xFFFF && TTF_GlyphMetrics(m_Font, static_cast<std::uint16_t>(ch), &minx, &maxx, &miny, &maxy, &advance) == 0;
+#endif
+		}
 
-		std::optional<SDL_Point> getSize(const std::string& text) noexcept
+		std::optional<SDL_Point> getSize(std::string_view text)
 		{
 			SDL_Point p;
-			if (TTF_SizeText(m_Font, text.c_str(), &p.x, &p.y) == 0)
+			if (TTF_SizeText(m_Font, toCString(text), &p.x, &p.y) == 0)
 			{
 				return p;
 			}
 			return std::nullopt;
 		}
 
-		bool querySize(const std::string& text, SDL_Point& size)noexcept { return TTF_SizeText(m_Font, text.c_str(), &size.x, &size.y) == 0; }
+		bool querySize(std::string_view text, SDL_Point& size) { return TTF_SizeText(m_Font, toCString(text), &size.x, &size.y) == 0; }
 
-		std::optional<SDL_Point> getSizeUTF8(const std::string& text)noexcept
+		std::optional<SDL_Point> getSizeUTF8(std::string_view text)
 		{
 			SDL_Point p;
-			if (TTF_SizeUTF8(m_Font, text.c_str(), &p.x, &p.y) == 0)
+			if (TTF_SizeUTF8(m_Font, toCString(text), &p.x, &p.y) == 0)
 			{
 				return p;
 			}
 			return std::nullopt;
 		}
 
-		bool querySizeUTF8(const std::string& text, SDL_Point& size)noexcept { return TTF_SizeUTF8(m_Font, text.c_str(), &size.x, &size.y) == 0; }
+		bool querySizeUTF8(std::string_view text, SDL_Point& size) { return TTF_SizeUTF8(m_Font, toCString(text), &size.x, &size.y) == 0; }
+
+		std::optional<SDL_Point> getSize(std::u32string_view text)
+		{
+			SDL_Point p;
+			if (TTF_SizeUTF8(m_Font, toCString(text), &p.x, &p.y) == 0)
+			{
+				return p;
+			}
+			return std::nullopt;
+		}
+
+		bool querySize(std::u32string_view text, SDL_Point& size) { return TTF_SizeUTF8(m_Font, toCString(text), &size.x, &size.y) == 0; }
 
 		std::optional<SDL_Point> getSizeUNICODE(const std::uint16_t* text)noexcept
 		{
@@ -136,31 +158,100 @@ namespace sdl2::ttf
 
 		bool querySizeUNICODE(const std::uint16_t* text, SDL_Point& size)noexcept { return TTF_SizeUNICODE(m_Font, text, &size.x, &size.y) == 0; }
 		
-		[[nodiscard]] sdl2::Surface renderSolid(std::uint16_t ch, SDL_Color fg)noexcept { return sdl2::Surface{ TTF_RenderGlyph_Solid(m_Font, ch, fg) }; }
-		[[nodiscard]] sdl2::Surface renderSolid(const std::string& text, SDL_Color fg)noexcept { return sdl2::Surface{ TTF_RenderText_Solid(m_Font, text.c_str(), fg) }; }
-		[[nodiscard]] sdl2::Surface renderUTF8Solid(const std::string& text, SDL_Color fg)noexcept { return sdl2::Surface{ TTF_RenderUTF8_Solid(m_Font, text.c_str(), fg) }; }
-		[[nodiscard]] sdl2::Surface renderSolid(const std::uint16_t* text, SDL_Color fg)noexcept { return sdl2::Surface{ TTF_RenderUNICODE_Solid(m_Font, text, fg) }; }
+		[[nodiscard]] sdl2::Surface renderSolid(char32_t ch, SDL_Color fg)noexcept
+		{
+			SDL2_TRACE_SCOPE("text", "Font::renderSolid");
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			return sdl2::Surface{ TTF_RenderGlyph32_Solid(m_Font, ch, fg) };
+#else
+			return ch <= 0xFFFF ? sdl2::Surface{ TTF_RenderGlyph_Solid(m_Font, static_cast<std::uint16_t>(ch), fg) } : sdl2::Surface{};
+#endif
+		}
+		[[nodiscard]] sdl2::Surface renderSolid(std::string_view text, SDL_Color fg) { SDL2_TRACE_SCOPE("text", "Font::renderSolid"); return sdl2::Surface{ TTF_RenderText_Solid(m_Font, toCString(text), fg) }; }
+		[[nodiscard]] sdl2::Surface renderUTF8Solid(std::string_view text, SDL_Color fg) { SDL2_TRACE_SCOPE("text", "Font::renderUTF8Solid"); return sdl2::Surface{ TTF_RenderUTF8_Solid(m_Font, toCString(text), fg) }; }
+		[[nodiscard]] sdl2::Surface renderSolid(const std::uint16_t* text, SDL_Color fg)noexcept { SDL2_TRACE_SCOPE("text", "Font::renderSolid"); return sdl2::Surface{ TTF_RenderUNICODE_Solid(m_Font, text, fg) }; }
+		[[nodiscard]] sdl2::Surface renderSolid(std::u32string_view text, SDL_Color fg) { SDL2_TRACE_SCOPE("text", "Font::renderSolid"); return sdl2::Surface{ TTF_RenderUTF8_Solid(m_Font, toCString(text), fg) }; }
 
-		[[nodiscard]] sdl2::Surface renderShaded(std::uint16_t ch, SDL_Color fg, SDL_Color bg)noexcept { return sdl2::Surface{ TTF_RenderGlyph_Shaded(m_Font, ch, fg, bg) }; }
-		[[nodiscard]] sdl2::Surface renderShaded(const std::string& text, SDL_Color fg, SDL_Color bg)noexcept { return sdl2::Surface{ TTF_RenderText_Shaded(m_Font, text.c_str(), fg, bg) }; }
-		[[nodiscard]] sdl2::Surface renderUTF8Shaded(const std::string& text, SDL_Color fg, SDL_Color bg)noexcept { return sdl2::Surface{ TTF_RenderUTF8_Shaded(m_Font, text.c_str(), fg, bg) }; }
-		[[nodiscard]] sdl2::Surface renderShaded(const std::uint16_t* text, SDL_Color fg, SDL_Color bg)noexcept { return sdl2::Surface{ TTF_RenderUNICODE_Shaded(m_Font, text, fg, bg) }; }
+		[[nodiscard]] sdl2::Surface renderShaded(char32_t ch, SDL_Color fg, SDL_Color bg)noexcept
+		{
+			SDL2_TRACE_SCOPE("text", "Font::renderShaded");
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			return sdl2::Surface{ TTF_RenderGlyph32_Shaded(m_Font, ch, fg, bg) };
+#else
+			return ch <= 0xFFFF ? sdl2::Surface{ TTF_RenderGlyph_Shaded(m_Font, static_cast<std::uint16_t>(ch), fg, bg) } : sdl2::Surface{};
+#endif
+		}
+		[[nodiscard]] sdl2::Surface renderShaded(std::string_view text, SDL_Color fg, SDL_Color bg) { SDL2_TRACE_SCOPE("text", "Font::renderShaded"); return sdl2::Surface{ TTF_RenderText_Shaded(m_Font, toCString(text), fg, bg) }; }
+		[[nodiscard]] sdl2::Surface renderUTF8Shaded(std::string_view text, SDL_Color fg, SDL_Color bg) { SDL2_TRACE_SCOPE("text", "Font::renderUTF8Shaded"); return sdl2::Surface{ TTF_RenderUTF8_Shaded(m_Font, toCString(text), fg, bg) }; }
+		[[nodiscard]] sdl2::Surface renderShaded(const std::uint16_t* text, SDL_Color fg, SDL_Color bg)noexcept { SDL2_TRACE_SCOPE("text", "Font::renderShaded"); return sdl2::Surface{ TTF_RenderUNICODE_Shaded(m_Font, text, fg, bg) }; }
+		[[nodiscard]] sdl2::Surface renderShaded(std::u32string_view text, SDL_Color fg, SDL_Color bg) { SDL2_TRACE_SCOPE("text", "Font::renderShaded"); return sdl2::Surface{ TTF_RenderUTF8_Shaded(m_Font, toCString(text), fg, bg) }; }
 
-		[[nodiscard]] sdl2::Surface renderBlended(std::uint16_t ch, SDL_Color fg)noexcept { return sdl2::Surface{ TTF_RenderGlyph_Blended(m_Font, ch, fg) }; }
-		[[nodiscard]] sdl2::Surface renderBlended(const std::string& text, SDL_Color fg)noexcept { return sdl2::Surface{ TTF_RenderText_Blended(m_Font, text.c_str(), fg) }; }
-		[[nodiscard]] sdl2::Surface renderUTF8Blended(const std::string& text, SDL_Color fg)noexcept { return sdl2::Surface{ TTF_RenderUTF8_Blended(m_Font, text.c_str(), fg) }; }
-		[[nodiscard]] sdl2::Surface renderBlended(const std::uint16_t* text, SDL_Color fg)noexcept { return sdl2::Surface{ TTF_RenderUNICODE_Blended(m_Font, text, fg) }; }
+		[[nodiscard]] sdl2::Surface renderBlended(char32_t ch, SDL_Color fg)noexcept
+		{
+			SDL2_TRACE_SCOPE("text", "Font::renderBlended");
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			return sdl2::Surface{ TTF_RenderGlyph32_Blended(m_Font, ch, fg) };
+#else
+			return ch <= 0xFFFF ? sdl2::Surface{ TTF_RenderGlyph_Blended(m_Font, static_cast<std::uint16_t>(ch), fg) } : sdl2::Surface{};
+#endif
+		}
+		[[nodiscard]] sdl2::Surface renderBlended(std::string_view text, SDL_Color fg) { SDL2_TRACE_SCOPE("text", "Font::renderBlended"); return sdl2::Surface{ TTF_RenderText_Blended(m_Font, toCString(text), fg) }; }
+		[[nodiscard]] sdl2::Surface renderUTF8Blended(std::string_view text, SDL_Color fg) { SDL2_TRACE_SCOPE("text", "Font::renderUTF8Blended"); return sdl2::Surface{ TTF_RenderUTF8_Blended(m_Font, toCString(text), fg) }; }
+		[[nodiscard]] sdl2::Surface renderBlended(const std::uint16_t* text, SDL_Color fg)noexcept { SDL2_TRACE_SCOPE("text", "Font::renderBlended"); return sdl2::Surface{ TTF_RenderUNICODE_Blended(m_Font, text, fg) }; }
+		[[nodiscard]] sdl2::Surface renderBlended(std::u32string_view text, SDL_Color fg) { SDL2_TRACE_SCOPE("text", "Font::renderBlended"); return sdl2::Surface{ TTF_RenderUTF8_Blended(m_Font, toCString(text), fg) }; }
 
-		[[nodiscard]] sdl2::Surface renderBlended(const std::string& text, SDL_Color fg, std::uint32_t wrapLength)noexcept { return sdl2::Surface{ TTF_RenderText_Blended_Wrapped(m_Font, text.c_str(), fg, wrapLength) }; }
-		[[nodiscard]] sdl2::Surface renderUTF8Blended(const std::string& text, SDL_Color fg, std::uint32_t wrapLength)noexcept { return sdl2::Surface{ TTF_RenderUTF8_Blended_Wrapped(m_Font, text.c_str(), fg, wrapLength) }; }
-		[[nodiscard]] sdl2::Surface renderBlended(const std::uint16_t* text, SDL_Color fg, std::uint32_t wrapLength)noexcept { return sdl2::Surface{ TTF_RenderUNICODE_Blended_Wrapped(m_Font, text, fg, wrapLength) }; }
+		[[nodiscard]] sdl2::Surface renderBlended(std::string_view text, SDL_Color fg, std::uint32_t wrapLength) { SDL2_TRACE_SCOPE("text", "Font::renderBlended"); return sdl2::Surface{ TTF_RenderText_Blended_Wrapped(m_Font, toCString(text), fg, wrapLength) }; }
+		[[nodiscard]] sdl2::Surface renderUTF8Blended(std::string_view text, SDL_Color fg, std::uint32_t wrapLength) { SDL2_TRACE_SCOPE("text", "Font::renderUTF8Blended"); return sdl2::Surface{ TTF_RenderUTF8_Blended_Wrapped(m_Font, toCString(text), fg, wrapLength) }; }
+		[[nodiscard]] sdl2::Surface renderBlended(const std::uint16_t* text, SDL_Color fg, std::uint32_t wrapLength)noexcept { SDL2_TRACE_SCOPE("text", "Font::renderBlended"); return sdl2::Surface{ TTF_RenderUNICODE_Blended_Wrapped(m_Font, text, fg, wrapLength) }; }
+		[[nodiscard]] sdl2::Surface renderBlended(std::u32string_view text, SDL_Color fg, std::uint32_t wrapLength) { SDL2_TRACE_SCOPE("text", "Font::renderBlended"); return sdl2::Surface{ TTF_RenderUTF8_Blended_Wrapped(m_Font, toCString(text), fg, wrapLength) }; }
 
-		[[nodiscard]] int getKerningSizeGlyphs(std::uint16_t previousCh, std::uint16_t ch)noexcept { return TTF_GetFontKerningSizeGlyphs(m_Font, previousCh, ch); }
+		[[nodiscard]] int getKerningSizeGlyphs(char32_t previousCh, char32_t ch)noexcept
+		{
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			return TTF_GetFontKerningSizeGlyphs32(m_Font, previousCh, ch);
+#else
+			return previousCh <= 0xFFFF && ch <= 0xFFFF ? TTF_GetFontKerningSizeGlyphs(m_Font, static_cast<std::uint16_t>(previousCh), static_cast<std::uint16_t>(ch)) : 0;
+#endif
+		}
 
 		[[nodiscard]] bool isValid()const noexcept { return m_Font != nullptr; }
 		[[nodiscard]] FontView get()const noexcept { return m_Font; }
 
 	private:
+		[[nodiscard]] int glyphIsProvided(char32_t ch)const noexcept
+		{
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			return TTF_GlyphIsProvided32(m_Font, ch);
+#else
+			return ch <= 0xFFFF ? TTF_GlyphIsProvided(m_Font, static_cast<std::uint16_t>(ch)) : 0;
+#endif
+		}
+
+		// SDL_ttf wants null terminated UTF-8; the per-thread scratch buffer is reused so steady state calls do not allocate.
+		[[nodiscard]] static std::string& getScratch()
+		{
+			thread_local std::string scratch;
+			return scratch;
+		}
+
+		static const char* toCString(std::string_view text)
+		{
+			std::string& scratch = getScratch();
+			scratch.assign(text.data(), text.size());
+			return scratch.c_str();
+		}
+
+		static const char* toCString(std::u32string_view text)
+		{
+			std::string& scratch = getScratch();
+			scratch.clear();
+			for (const char32_t ch : text)
+			{
+				sdl2::ttf::appendUTF8(scratch, ch);
+			}
+			return scratch.c_str();
+		}
+
 		TTF_Font* m_Font = nullptr;
 	};
 
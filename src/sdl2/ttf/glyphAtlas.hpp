@@ -0,0 +1,252 @@
+#pragma once
+
+#include "../surface.hpp"
+#include "../texture.hpp"
+#include "font.hpp"
+
+#include <SDL_render.h>
+#include <SDL_ttf.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace sdl2::ttf
+{
+	struct AtlasGlyph
+	{
+		int page = -1; // -1 for glyphs without pixels, e.g. spaces
+		SDL_Rect rect{ 0, 0, 0, 0 };
+		int offsetX = 0; // left edge of the bitmap relative to the pen
+		int advance = 0;
+	};
+
+	// Produces the bitmap of a glyph at the given scale in place of SDL_ttf, e.g. from a distance field.
+	using GlyphRasterizer = bool (*)(void* data, char32_t codepoint, float scale, sdl2::Surface& surface, int& offsetX, int& advance);
+
+	// Rasterizes glyphs of one font on demand into shelf-packed texture pages.
+	// Glyph bitmaps are laid out the way SDL_ttf renders a single glyph: the top edge is the line
+	// top and the left edge sits min(minx, 0) from the pen position.
+	class GlyphAtlas
+	{
+	public:
+		[[nodiscard]] GlyphAtlas(RendererView renderer, FontView font, int pageSize = 512)
+			: m_Renderer(renderer)
+			, m_Font(font)
+			, m_PageSize(pageSize)
+		{}
+
+		GlyphAtlas(const GlyphAtlas&) = delete;
+		GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+		// Returns nullptr when the font has no such glyph.
+		const AtlasGlyph* find(char32_t codepoint)
+		{
+			if (const auto it = m_Glyphs.find(codepoint); it != m_Glyphs.end())
+			{
+				return &it->second;
+			}
+			if (m_Rasterizer != nullptr)
+			{
+				sdl2::Surface surface;
+				int offsetX = 0;
+				int advance = 0;
+				if (!m_Rasterizer(m_RasterizerData, codepoint, m_Scale, surface, offsetX, advance))
+				{
+					return nullptr;
+				}
+				return insert(codepoint, surface, offsetX, advance);
+			}
+			int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+			if (!queryMetrics(codepoint, minx, maxx, miny, maxy, advance))
+			{
+				return nullptr;
+			}
+			sdl2::Surface surface{ renderGlyph(codepoint) };
+			return insert(codepoint, surface, std::min(minx, 0), advance);
+		}
+
+		[[nodiscard]] bool contains(char32_t codepoint)const { return m_Glyphs.find(codepoint) != m_Glyphs.end(); }
+
+		// Uploads an already rasterized glyph; the surface may be empty for blank glyphs.
+		const AtlasGlyph* insert(char32_t codepoint, sdl2::Surface& surface, int offsetX, int advance)
+		{
+			AtlasGlyph glyph;
+			glyph.offsetX = offsetX;
+			glyph.advance = advance;
+			if (surface.isValid() && surface.getWidth() > 0 && surface.getHeight() > 0)
+			{
+				const bool isConverted = surface.getPixelFormat()->format == SDL_PIXELFORMAT_ARGB8888;
+				sdl2::Surface converted = isConverted ? sdl2::Surface{} : surface.convert(SDL_PIXELFORMAT_ARGB8888);
+				const sdl2::Surface& pixels = isConverted ? surface : converted;
+				if (!pixels.isValid() || !allocate(pixels.getWidth(), pixels.getHeight(), glyph)
+					|| !m_Pages[static_cast<std::size_t>(glyph.page)].update(glyph.rect, pixels.getPixels(), pixels.getPitch()))
+				{
+					return nullptr;
+				}
+			}
+			return &(m_Glyphs[codepoint] = glyph);
+		}
+
+		// Replaces SDL_ttf rasterization; font metrics are multiplied by scale. Drops every cached glyph.
+		void setRasterizer(GlyphRasterizer rasterizer, void* data, float scale = 1.0f)
+		{
+			clear();
+			m_Rasterizer = rasterizer;
+			m_RasterizerData = data;
+			m_Scale = scale;
+		}
+
+		[[nodiscard]] float getScale()const noexcept { return m_Scale; }
+
+		[[nodiscard]] int getKerning(char32_t previous, char32_t codepoint)const noexcept
+		{
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			return scaled(TTF_GetFontKerningSizeGlyphs32(m_Font, previous, codepoint));
+#else
+			return previous > 0xFFFF || codepoint > 0xFFFF ? 0 : scaled(TTF_GetFontKerningSizeGlyphs(m_Font, static_cast<std::uint16_t>(previous), static_cast<std::uint16_t>(codepoint)));
+#endif
+		}
+
+		[[nodiscard]] SDL_Texture* getPage(int page)const noexcept { return m_Pages[static_cast<std::size_t>(page)].get(); }
+
+		[[nodiscard]] int getPagesCount()const noexcept { return static_cast<int>(m_Pages.size()); }
+
+		[[nodiscard]] int getPageSize()const noexcept { return m_PageSize; }
+
+		[[nodiscard]] std::size_t getGlyphsCount()const noexcept { return m_Glyphs.size(); }
+
+		[[nodiscard]] int getLineSkip()const noexcept { return scaled(TTF_FontLineSkip(m_Font)); }
+
+		[[nodiscard]] int getHeight()const noexcept { return scaled(TTF_FontHeight(m_Font)); }
+
+		[[nodiscard]] FontView getFont()const noexcept { return m_Font; }
+
+		[[nodiscard]] RendererView getRenderer()const noexcept { return m_Renderer; }
+
+		// Changes whenever cached glyphs are dropped; AtlasGlyph values from an older generation are stale.
+		[[nodiscard]] std::uint32_t getGeneration()const noexcept { return m_Generation; }
+
+		void clear()
+		{
+			m_Glyphs.clear();
+			m_Pages.clear();
+			m_Shelves.clear();
+			++m_Generation;
+		}
+
+	private:
+		static constexpr int PADDING = 1;
+
+		struct Shelf
+		{
+			int page = 0;
+			int y = 0;
+			int height = 0;
+			int x = 0;
+		};
+
+		[[nodiscard]] int scaled(int value)const noexcept { return static_cast<int>(std::lround(static_cast<float>(value) * m_Scale)); }
+
+		bool queryMetrics(char32_t codepoint, int& minx, int& maxx, int& miny, int& maxy, int& advance)const noexcept
+		{
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			return TTF_GlyphIsProvided32(m_Font, codepoint) != 0 && TTF_GlyphMetrics32(m_Font, codepoint, &minx, &maxx, &miny, &maxy, &advance) == 0;
+#else
+			const auto ch = static_cast<std::uint16_t>(codepoint);
+			return codepoint <= 0xFFFF && TTF_GlyphIsProvided(m_Font, ch) != 0 && TTF_GlyphMetrics(m_Font, ch, &minx, &maxx, &miny, &maxy, &advance) == 0;
+#endif
+		}
+
+		[[nodiscard]] SDL_Surface* renderGlyph(char32_t codepoint)const noexcept
+		{
+			constexpr SDL_Color white{ 255, 255, 255, 255 };
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			return TTF_RenderGlyph32_Blended(m_Font, codepoint, white);
+#else
+			return TTF_RenderGlyph_Blended(m_Font, static_cast<std::uint16_t>(codepoint), white);
+#endif
+		}
+
+		bool allocate(int w, int h, AtlasGlyph& glyph)
+		{
+			const int width = w + PADDING;
+			const int height = h + PADDING;
+			if (width > m_PageSize || height > m_PageSize)
+			{
+				return false;
+			}
+			Shelf* best = nullptr;
+			for (Shelf& shelf : m_Shelves)
+			{
+				if (shelf.height >= height && shelf.x + width <= m_PageSize && (best == nullptr || shelf.height < best->height))
+				{
+					best = &shelf;
+				}
+			}
+			if (best == nullptr)
+			{
+				best = openShelf(height);
+				if (best == nullptr)
+				{
+					return false;
+				}
+			}
+			glyph.page = best->page;
+			glyph.rect = SDL_Rect{ best->x, best->y, w, h };
+			best->x += width;
+			return true;
+		}
+
+		Shelf* openShelf(int height)
+		{
+			int page = getPagesCount() - 1;
+			int y = 0;
+			for (const Shelf& shelf : m_Shelves)
+			{
+				if (shelf.page == page)
+				{
+					y = std::max(y, shelf.y + shelf.height);
+				}
+			}
+			if (page < 0 || y + height > m_PageSize)
+			{
+				if (!addPage())
+				{
+					return nullptr;
+				}
+				page = getPagesCount() - 1;
+				y = 0;
+			}
+			m_Shelves.push_back(Shelf{ page, y, height, 0 });
+			return &m_Shelves.back();
+		}
+
+		bool addPage()
+		{
+			sdl2::Texture page{ m_Renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, m_PageSize, m_PageSize };
+			if (!page.isValid())
+			{
+				return false;
+			}
+			// Static textures start undefined; clear them so filtering never picks up garbage around glyphs.
+			const std::vector<std::uint32_t> blank(static_cast<std::size_t>(m_PageSize) * static_cast<std::size_t>(m_PageSize), 0u);
+			page.update(blank.data(), m_PageSize * 4);
+			page.setBlendMode(SDL_BLENDMODE_BLEND);
+			m_Pages.push_back(std::move(page));
+			return true;
+		}
+
+		RendererView m_Renderer;
+		FontView m_Font;
+		int m_PageSize;
+		std::vector<sdl2::Texture> m_Pages;
+		std::vector<Shelf> m_Shelves;
+		std::unordered_map<char32_t, AtlasGlyph> m_Glyphs;
+		GlyphRasterizer m_Rasterizer = nullptr;
+		void* m_RasterizerData = nullptr;
+		float m_Scale = 1.0f;
+		std::uint32_t m_Generation = 0;
+	};
+}
@@ -0,0 +1,297 @@
+#pragma once
+
+#include "../surface.hpp"
+#include "font.hpp"
+#include "glyphAtlas.hpp"
+#include "utf8.hpp"
+
+#include <SDL_pixels.h>
+#include <SDL_ttf.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace sdl2::ttf
+{
+	struct WarmupProgress
+	{
+		std::size_t total = 0;
+		std::size_t rasterized = 0;
+		std::size_t uploaded = 0;
+	};
+
+	// Rasterizes a known character set ahead of time on worker threads.
+	// TTF_Font is not thread-safe, so every worker opens its own instance of the atlas font (with
+	// the same style, outline and hinting); only opening and closing are serialized. Finished
+	// bitmaps wait in a queue until upload() moves them into the atlas on the render thread,
+	// spending at most the given time per call. Atlases bound to a custom rasterizer (SdfAtlas)
+	// are not supported.
+	class GlyphWarmup
+	{
+	public:
+		[[nodiscard]] GlyphWarmup(GlyphAtlas& atlas, const std::string& file, int ptsize, long index = 0)
+			: m_Atlas(atlas)
+			, m_File(file)
+			, m_PtSize(ptsize)
+			, m_Index(index)
+			, m_Style(TTF_GetFontStyle(atlas.getFont()))
+			, m_Outline(TTF_GetFontOutline(atlas.getFont()))
+			, m_Hinting(TTF_GetFontHinting(atlas.getFont()))
+		{}
+
+		GlyphWarmup(const GlyphWarmup&) = delete;
+		GlyphWarmup& operator=(const GlyphWarmup&) = delete;
+
+		~GlyphWarmup()noexcept { cancel(); }
+
+		void add(std::u32string_view codepoints)
+		{
+			for (const char32_t codepoint : codepoints)
+			{
+				add(codepoint);
+			}
+		}
+
+		// Queues every distinct code point of a UTF-8 corpus.
+		void addText(std::string_view text)
+		{
+			for (std::size_t position = 0; position < text.size();)
+			{
+				add(decodeUTF8(text, position));
+			}
+		}
+
+		// Code points added while a run is in progress wait for the next start().
+		void add(char32_t codepoint)
+		{
+			if (codepoint >= U' ' && !m_Atlas.contains(codepoint) && m_Seen.insert(codepoint).second)
+			{
+				(isRunning() ? m_Pending : m_Codepoints).push_back(codepoint);
+			}
+		}
+
+		// Rasterizes the code points added so far that no earlier run has uploaded.
+		bool start(unsigned threadsCount = std::max(std::thread::hardware_concurrency(), 2u) - 1)
+		{
+			if (isRunning())
+			{
+				return false;
+			}
+			m_Codepoints.erase(std::remove_if(m_Codepoints.begin(), m_Codepoints.end(), [this](char32_t codepoint) { return m_UploadedCodepoints.count(codepoint) != 0; }), m_Codepoints.end());
+			m_UploadedCodepoints.clear();
+			m_Codepoints.insert(m_Codepoints.end(), m_Pending.begin(), m_Pending.end());
+			m_Pending.clear();
+			if (m_Codepoints.empty())
+			{
+				return false;
+			}
+			m_Next.store(0, std::memory_order_relaxed);
+			m_Rasterized.store(0, std::memory_order_relaxed);
+			m_Uploaded = 0;
+			m_Cancelled.store(false, std::memory_order_relaxed);
+			m_Workers.reserve(threadsCount);
+			for (unsigned i = 0; i < std::max(threadsCount, 1u); ++i)
+			{
+				m_Workers.emplace_back([this] { work(); });
+			}
+			return true;
+		}
+
+		// Moves finished glyphs into the atlas until the budget runs out; returns how many were uploaded.
+		std::size_t upload(std::chrono::microseconds budget = std::chrono::microseconds{ 2000 })
+		{
+			const auto deadline = std::chrono::steady_clock::now() + budget;
+			std::size_t uploaded = 0;
+			do
+			{
+				{
+					std::lock_guard lock{ m_ResultsMutex };
+					if (m_Results.empty())
+					{
+						break;
+					}
+					m_Uploading.swap(m_Results);
+				}
+				std::size_t i = 0;
+				for (; i < m_Uploading.size() && (i == 0 || std::chrono::steady_clock::now() < deadline); ++i)
+				{
+					Result& result = m_Uploading[i];
+					sdl2::Surface surface{ result.surface };
+					// The atlas may have rasterized the glyph itself since it was queued.
+					if (result.isProvided && !m_Atlas.contains(result.codepoint))
+					{
+						m_Atlas.insert(result.codepoint, surface, result.offsetX, result.advance);
+					}
+					m_UploadedCodepoints.insert(result.codepoint);
+					++uploaded;
+				}
+				if (i < m_Uploading.size())
+				{
+					std::lock_guard lock{ m_ResultsMutex };
+					m_Results.insert(m_Results.begin(), m_Uploading.begin() + static_cast<std::ptrdiff_t>(i), m_Uploading.end());
+				}
+				m_Uploading.clear();
+			} while (std::chrono::steady_clock::now() < deadline);
+
+			m_Uploaded += uploaded;
+			if (isRunning() && m_Uploaded == m_Codepoints.size())
+			{
+				join();
+			}
+			return uploaded;
+		}
+
+		[[nodiscard]] WarmupProgress getProgress()const noexcept
+		{
+			return WarmupProgress{ m_Codepoints.size(), m_Rasterized.load(std::memory_order_relaxed), m_Uploaded };
+		}
+
+		[[nodiscard]] bool isDone()const noexcept { return m_Uploaded == m_Codepoints.size(); }
+
+		[[nodiscard]] bool isRunning()const noexcept { return !m_Workers.empty(); }
+
+		// Stops the workers and drops every glyph that has not been uploaded yet.
+		void cancel()noexcept
+		{
+			m_Cancelled.store(true, std::memory_order_relaxed);
+			join();
+			std::lock_guard lock{ m_ResultsMutex };
+			for (Result& result : m_Results)
+			{
+				SDL_FreeSurface(result.surface);
+			}
+			m_Results.clear();
+		}
+
+	private:
+		struct Result
+		{
+			char32_t codepoint = 0;
+			SDL_Surface* surface = nullptr;
+			int offsetX = 0;
+			int advance = 0;
+			bool isProvided = false;
+		};
+
+		static std::mutex& getFontMutex()noexcept
+		{
+			static std::mutex mutex;
+			return mutex;
+		}
+
+		void join()noexcept
+		{
+			for (std::thread& worker : m_Workers)
+			{
+				worker.join();
+			}
+			m_Workers.clear();
+		}
+
+		void work()
+		{
+			TTF_Font* font = nullptr;
+			{
+				std::lock_guard lock{ getFontMutex() };
+				font = TTF_OpenFontIndex(m_File.c_str(), m_PtSize, m_Index);
+				if (font != nullptr)
+				{
+					TTF_SetFontStyle(font, m_Style);
+					TTF_SetFontOutline(font, m_Outline);
+					TTF_SetFontHinting(font, m_Hinting);
+				}
+			}
+			std::vector<Result> batch;
+			for (std::size_t i = m_Next.fetch_add(1, std::memory_order_relaxed); i < m_Codepoints.size() && !m_Cancelled.load(std::memory_order_relaxed);
+				i = m_Next.fetch_add(1, std::memory_order_relaxed))
+			{
+				Result result;
+				result.codepoint = m_Codepoints[i];
+				if (font != nullptr)
+				{
+					rasterize(font, result);
+				}
+				batch.push_back(result);
+				m_Rasterized.fetch_add(1, std::memory_order_relaxed);
+				if (batch.size() >= BATCH_SIZE)
+				{
+					publish(batch);
+				}
+			}
+			publish(batch);
+			std::lock_guard lock{ getFontMutex() };
+			if (font != nullptr)
+			{
+				TTF_CloseFont(font);
+			}
+		}
+
+		static void rasterize(TTF_Font* font, Result& result)noexcept
+		{
+			constexpr SDL_Color white{ 255, 255, 255, 255 };
+			int minx = 0, maxx = 0, miny = 0, maxy = 0;
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			if (TTF_GlyphIsProvided32(font, result.codepoint) == 0 || TTF_GlyphMetrics32(font, result.codepoint, &minx, &maxx, &miny, &maxy, &result.advance) != 0)
+			{
+				return;
+			}
+			SDL_Surface* rendered = TTF_RenderGlyph32_Blended(font, result.codepoint, white);
+#else
+			const auto ch = static_cast<std::uint16_t>(result.codepoint);
+			if (result.codepoint > 0xFFFF || TTF_GlyphIsProvided(font, ch) == 0 || TTF_GlyphMetrics(font, ch, &minx, &maxx, &miny, &maxy, &result.advance) != 0)
+			{
+				return;
+			}
+			SDL_Surface* rendered = TTF_RenderGlyph_Blended(font, ch, white);
+#endif
+			result.isProvided = true;
+			result.offsetX = std::min(minx, 0);
+			if (rendered != nullptr)
+			{
+				result.surface = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+				SDL_FreeSurface(rendered);
+			}
+		}
+
+		void publish(std::vector<Result>& batch)
+		{
+			if (!batch.empty())
+			{
+				std::lock_guard lock{ m_ResultsMutex };
+				m_Results.insert(m_Results.end(), batch.begin(), batch.end());
+				batch.clear();
+			}
+		}
+
+		static constexpr std::size_t BATCH_SIZE = 16;
+
+		GlyphAtlas& m_Atlas;
+		std::string m_File;
+		int m_PtSize;
+		long m_Index;
+		int m_Style;
+		int m_Outline;
+		int m_Hinting;
+
+		std::vector<char32_t> m_Codepoints;
+		std::vector<char32_t> m_Pending;
+		std::unordered_set<char32_t> m_Seen;
+		std::unordered_set<char32_t> m_UploadedCodepoints;
+		std::vector<std::thread> m_Workers;
+		std::atomic<std::size_t> m_Next{ 0 };
+		std::atomic<std::size_t> m_Rasterized{ 0 };
+		std::atomic<bool> m_Cancelled{ false };
+		std::size_t m_Uploaded = 0;
+
+		std::mutex m_ResultsMutex;
+		std::vector<Result> m_Results;
+		std::vector<Result> m_Uploading;
+	};
+}
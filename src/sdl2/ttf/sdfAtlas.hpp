@@ -0,0 +1,364 @@
+#pragma once
+
+#include "../surface.hpp"
+#include "font.hpp"
+#include "glyphAtlas.hpp"
+
+#include <SDL_pixels.h>
+#include <SDL_rwops.h>
+#include <SDL_ttf.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sdl2::ttf
+{
+	struct SdfGlyph
+	{
+		int width = 0; // including the spread on every side
+		int height = 0;
+		int offsetX = 0;
+		int advance = 0;
+		std::vector<std::uint8_t> distance; // 128 on the outline, larger inside
+	};
+
+	// SDF-sourced multi-size rasterization: signed distance fields of one font opened at a single,
+	// preferably large, size serve as the source for glyph bitmaps at any other size.
+	// Each size is still a separate set of bitmaps: the field is resampled and thresholded on the
+	// CPU and uploaded through a GlyphAtlas bound with bind(), one atlas per size, so text renders
+	// with the usual geometry batches. SDL_Renderer has no alpha-test shader, which is why the
+	// fields themselves are never uploaded. The fields can be saved and loaded to skip generation
+	// on the next start.
+	class SdfAtlas
+	{
+	public:
+		[[nodiscard]] explicit SdfAtlas(FontView font, int spread = 6)noexcept
+			: m_Font(font)
+			, m_Spread(std::clamp(spread, 1, 64))
+		{}
+
+		SdfAtlas(const SdfAtlas&) = delete;
+		SdfAtlas& operator=(const SdfAtlas&) = delete;
+
+		// Generates the field on first use; returns nullptr when the font has no such glyph.
+		const SdfGlyph* find(char32_t codepoint)
+		{
+			if (const auto it = m_Glyphs.find(codepoint); it != m_Glyphs.end())
+			{
+				return &it->second;
+			}
+			return generate(codepoint) ? &m_Glyphs[codepoint] : nullptr;
+		}
+
+		bool generate(std::u32string_view codepoints)
+		{
+			bool success = true;
+			for (const char32_t codepoint : codepoints)
+			{
+				success &= find(codepoint) != nullptr;
+			}
+			return success;
+		}
+
+		// Makes the atlas produce its glyphs from the fields at the given scale of the base size.
+		// The atlas must have been created for the same font.
+		void bind(GlyphAtlas& atlas, float scale) { atlas.setRasterizer(&SdfAtlas::rasterize, this, scale); }
+
+		void bindHeight(GlyphAtlas& atlas, int pixelHeight) { bind(atlas, static_cast<float>(pixelHeight) / static_cast<float>(std::max(TTF_FontHeight(m_Font), 1))); }
+
+		[[nodiscard]] sdl2::Surface render(const SdfGlyph& glyph, float scale)const
+		{
+			const int sourceWidth = glyph.width - 2 * m_Spread;
+			const int sourceHeight = glyph.height - 2 * m_Spread;
+			const int width = std::max(static_cast<int>(std::lround(static_cast<float>(sourceWidth) * scale)), 1);
+			const int height = std::max(static_cast<int>(std::lround(static_cast<float>(sourceHeight) * scale)), 1);
+			sdl2::Surface surface{ 0, width, height, 32, SDL_PIXELFORMAT_ARGB8888 };
+			if (!surface.isValid())
+			{
+				return surface;
+			}
+			const float step = 1.0f / scale;
+			const float toPixels = static_cast<float>(m_Spread) / 127.0f;
+			for (int y = 0; y < height; ++y)
+			{
+				auto* row = reinterpret_cast<std::uint32_t*>(static_cast<std::uint8_t*>(surface.getPixels()) + y * surface.getPitch());
+				const float v = static_cast<float>(m_Spread) + (static_cast<float>(y) + 0.5f) * step - 0.5f;
+				for (int x = 0; x < width; ++x)
+				{
+					const float u = static_cast<float>(m_Spread) + (static_cast<float>(x) + 0.5f) * step - 0.5f;
+					const float distance = (sample(glyph, u, v) - 128.0f) * toPixels;
+					const float coverage = std::clamp(distance * scale + 0.5f, 0.0f, 1.0f);
+					row[x] = (static_cast<std::uint32_t>(std::lround(coverage * 255.0f)) << 24) | 0x00FFFFFFu;
+				}
+			}
+			return surface;
+		}
+
+		bool save(const std::string& file)const
+		{
+			SDL_RWops* rw = SDL_RWFromFile(file.c_str(), "wb");
+			if (rw == nullptr)
+			{
+				return false;
+			}
+			bool success = SDL_WriteLE32(rw, MAGIC) == 1 && SDL_WriteLE32(rw, static_cast<std::uint32_t>(m_Spread)) == 1
+				&& SDL_WriteLE32(rw, static_cast<std::uint32_t>(TTF_FontHeight(m_Font))) == 1
+				&& SDL_WriteLE32(rw, static_cast<std::uint32_t>(m_Glyphs.size())) == 1;
+			for (const auto& [codepoint, glyph] : m_Glyphs)
+			{
+				if (!success)
+				{
+					break;
+				}
+				success = SDL_WriteLE32(rw, codepoint) == 1
+					&& SDL_WriteLE16(rw, static_cast<std::uint16_t>(glyph.width)) == 1 && SDL_WriteLE16(rw, static_cast<std::uint16_t>(glyph.height)) == 1
+					&& SDL_WriteLE32(rw, static_cast<std::uint32_t>(glyph.offsetX)) == 1 && SDL_WriteLE32(rw, static_cast<std::uint32_t>(glyph.advance)) == 1
+					&& SDL_RWwrite(rw, glyph.distance.data(), 1, glyph.distance.size()) == glyph.distance.size();
+			}
+			return SDL_RWclose(rw) == 0 && success;
+		}
+
+		// Adds the glyphs of a file saved for the same font size and spread.
+		// Stops at the first glyph whose field could not have been generated for this font.
+		bool load(const std::string& file)
+		{
+			SDL_RWops* rw = SDL_RWFromFile(file.c_str(), "rb");
+			if (rw == nullptr)
+			{
+				return false;
+			}
+			bool success = SDL_ReadLE32(rw) == MAGIC && SDL_ReadLE32(rw) == static_cast<std::uint32_t>(m_Spread)
+				&& SDL_ReadLE32(rw) == static_cast<std::uint32_t>(TTF_FontHeight(m_Font));
+			const std::uint32_t count = success ? SDL_ReadLE32(rw) : 0;
+			success &= count <= MAX_CODEPOINT + 1;
+			for (std::uint32_t i = 0; success && i < count; ++i)
+			{
+				const char32_t codepoint = SDL_ReadLE32(rw);
+				SdfGlyph glyph;
+				glyph.width = SDL_ReadLE16(rw);
+				glyph.height = SDL_ReadLE16(rw);
+				glyph.offsetX = static_cast<std::int32_t>(SDL_ReadLE32(rw));
+				glyph.advance = static_cast<std::int32_t>(SDL_ReadLE32(rw));
+				if (codepoint > MAX_CODEPOINT || !isValidField(glyph.width, glyph.height))
+				{
+					success = false;
+					break;
+				}
+				glyph.distance.resize(static_cast<std::size_t>(glyph.width) * static_cast<std::size_t>(glyph.height));
+				success = SDL_RWread(rw, glyph.distance.data(), 1, glyph.distance.size()) == glyph.distance.size();
+				if (success)
+				{
+					m_Glyphs[codepoint] = std::move(glyph);
+				}
+			}
+			SDL_RWclose(rw);
+			return success;
+		}
+
+		[[nodiscard]] int getSpread()const noexcept { return m_Spread; }
+
+		[[nodiscard]] std::size_t getGlyphsCount()const noexcept { return m_Glyphs.size(); }
+
+		[[nodiscard]] std::size_t getMemoryUsage()const noexcept
+		{
+			std::size_t bytes = 0;
+			for (const auto& [codepoint, glyph] : m_Glyphs)
+			{
+				bytes += glyph.distance.size();
+			}
+			return bytes;
+		}
+
+		[[nodiscard]] FontView getFont()const noexcept { return m_Font; }
+
+		void clear()noexcept { m_Glyphs.clear(); }
+
+	private:
+		static constexpr std::uint32_t MAGIC = 0x31464453; // "SDF1"
+		static constexpr char32_t MAX_CODEPOINT = 0x10FFFF;
+		static constexpr int MAX_ASPECT = 4; // widest glyph bitmap in font heights
+
+		struct Offset
+		{
+			int x = 0;
+			int y = 0;
+
+			[[nodiscard]] constexpr int length2()const noexcept { return x * x + y * y; }
+		};
+
+		// Blank glyphs have no field; others are the rendered glyph plus the spread on every side.
+		[[nodiscard]] bool isValidField(int width, int height)const noexcept
+		{
+			if (width == 0 && height == 0)
+			{
+				return true;
+			}
+			const int fontHeight = std::max(TTF_FontHeight(m_Font), 1);
+			return width > 2 * m_Spread && height > 2 * m_Spread
+				&& width <= MAX_ASPECT * fontHeight + 2 * m_Spread && height <= fontHeight + 2 * m_Spread;
+		}
+
+		bool generate(char32_t codepoint)
+		{
+			int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+			constexpr SDL_Color white{ 255, 255, 255, 255 };
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+			if (TTF_GlyphIsProvided32(m_Font, codepoint) == 0 || TTF_GlyphMetrics32(m_Font, codepoint, &minx, &maxx, &miny, &maxy, &advance) != 0)
+			{
+				return false;
+			}
+			sdl2::Surface rendered{ TTF_RenderGlyph32_Blended(m_Font, codepoint, white) };
+#else
+			const auto ch = static_cast<std::uint16_t>(codepoint);
+			if (codepoint > 0xFFFF || TTF_GlyphIsProvided(m_Font, ch) == 0 || TTF_GlyphMetrics(m_Font, ch, &minx, &maxx, &miny, &maxy, &advance) != 0)
+			{
+				return false;
+			}
+			sdl2::Surface rendered{ TTF_RenderGlyph_Blended(m_Font, ch, white) };
+#endif
+			SdfGlyph glyph;
+			glyph.offsetX = std::min(minx, 0);
+			glyph.advance = advance;
+			if (rendered.isValid() && rendered.getWidth() > 0 && rendered.getHeight() > 0)
+			{
+				if (!isValidField(rendered.getWidth() + 2 * m_Spread, rendered.getHeight() + 2 * m_Spread))
+				{
+					return false;
+				}
+				sdl2::Surface converted = rendered.convert(SDL_PIXELFORMAT_ARGB8888);
+				if (!converted.isValid())
+				{
+					return false;
+				}
+				buildField(converted, glyph);
+			}
+			m_Glyphs[codepoint] = std::move(glyph);
+			return true;
+		}
+
+		void buildField(sdl2::Surface& surface, SdfGlyph& glyph)const
+		{
+			const int width = surface.getWidth() + 2 * m_Spread;
+			const int height = surface.getHeight() + 2 * m_Spread;
+			const auto size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+			constexpr Offset far{ 1 << 12, 1 << 12 };
+			std::vector<Offset> toInside(size, far);
+			std::vector<Offset> toOutside(size, Offset{});
+
+			for (int y = 0; y < surface.getHeight(); ++y)
+			{
+				const auto* row = reinterpret_cast<const std::uint32_t*>(static_cast<const std::uint8_t*>(surface.getPixels()) + y * surface.getPitch());
+				for (int x = 0; x < surface.getWidth(); ++x)
+				{
+					if ((row[x] >> 24) >= 128)
+					{
+						const auto index = static_cast<std::size_t>(y + m_Spread) * static_cast<std::size_t>(width) + static_cast<std::size_t>(x + m_Spread);
+						toInside[index] = Offset{};
+						toOutside[index] = far;
+					}
+				}
+			}
+			sweep(toInside, width, height);
+			sweep(toOutside, width, height);
+
+			glyph.width = width;
+			glyph.height = height;
+			glyph.distance.resize(size);
+			const float scale = 127.0f / static_cast<float>(m_Spread);
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				const float distance = std::sqrt(static_cast<float>(toOutside[i].length2())) - std::sqrt(static_cast<float>(toInside[i].length2()));
+				glyph.distance[i] = static_cast<std::uint8_t>(std::clamp(std::lround(128.0f + distance * scale), 0L, 255L));
+			}
+		}
+
+		// 8-point sequential Euclidean distance transform.
+		static void sweep(std::vector<Offset>& grid, int width, int height)
+		{
+			const auto at = [&](int x, int y) -> Offset& { return grid[static_cast<std::size_t>(y) * static_cast<std::size_t>(width) + static_cast<std::size_t>(x)]; };
+			const auto compare = [&](int x, int y, int dx, int dy)
+			{
+				if (x + dx < 0 || x + dx >= width || y + dy < 0 || y + dy >= height)
+				{
+					return;
+				}
+				const Offset& other = at(x + dx, y + dy);
+				const Offset candidate{ other.x + dx, other.y + dy };
+				if (candidate.length2() < at(x, y).length2())
+				{
+					at(x, y) = candidate;
+				}
+			};
+			for (int y = 0; y < height; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					compare(x, y, -1, 0);
+					compare(x, y, 0, -1);
+					compare(x, y, -1, -1);
+					compare(x, y, 1, -1);
+				}
+				for (int x = width - 1; x >= 0; --x)
+				{
+					compare(x, y, 1, 0);
+				}
+			}
+			for (int y = height - 1; y >= 0; --y)
+			{
+				for (int x = width - 1; x >= 0; --x)
+				{
+					compare(x, y, 1, 0);
+					compare(x, y, 0, 1);
+					compare(x, y, -1, 1);
+					compare(x, y, 1, 1);
+				}
+				for (int x = 0; x < width; ++x)
+				{
+					compare(x, y, -1, 0);
+				}
+			}
+		}
+
+		[[nodiscard]] static float sample(const SdfGlyph& glyph, float u, float v)noexcept
+		{
+			const float x = std::clamp(u, 0.0f, static_cast<float>(glyph.width - 1));
+			const float y = std::clamp(v, 0.0f, static_cast<float>(glyph.height - 1));
+			const int x0 = static_cast<int>(x);
+			const int y0 = static_cast<int>(y);
+			const int x1 = std::min(x0 + 1, glyph.width - 1);
+			const int y1 = std::min(y0 + 1, glyph.height - 1);
+			const float fx = x - static_cast<float>(x0);
+			const float fy = y - static_cast<float>(y0);
+			const auto at = [&](int px, int py) { return static_cast<float>(glyph.distance[static_cast<std::size_t>(py) * static_cast<std::size_t>(glyph.width) + static_cast<std::size_t>(px)]); };
+			const float top = at(x0, y0) + (at(x1, y0) - at(x0, y0)) * fx;
+			const float bottom = at(x0, y1) + (at(x1, y1) - at(x0, y1)) * fx;
+			return top + (bottom - top) * fy;
+		}
+
+		static bool rasterize(void* data, char32_t codepoint, float scale, sdl2::Surface& surface, int& offsetX, int& advance)
+		{
+			auto* atlas = static_cast<SdfAtlas*>(data);
+			const SdfGlyph* glyph = atlas->find(codepoint);
+			if (glyph == nullptr)
+			{
+				return false;
+			}
+			offsetX = static_cast<int>(std::lround(static_cast<float>(glyph->offsetX) * scale));
+			advance = static_cast<int>(std::lround(static_cast<float>(glyph->advance) * scale));
+			if (!glyph->distance.empty())
+			{
+				surface = atlas->render(*glyph, scale);
+			}
+			return true;
+		}
+
+		FontView m_Font;
+		int m_Spread;
+		std::unordered_map<char32_t, SdfGlyph> m_Glyphs;
+	};
+}
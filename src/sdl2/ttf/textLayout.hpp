@@ -0,0 +1,388 @@
+#pragma once
+
+#include "../renderer.hpp"
+#include "glyphAtlas.hpp"
+#include "utf8.hpp"
+
+#include <SDL_render.h>
+#include <SDL_version.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sdl2::ttf
+{
+	// UTF-8 text shaped once into positioned glyphs with greedy word wrapping.
+	// append() continues from the current pen position, so only the new text and at most the
+	// last word of the previous text are laid out again. Drawing goes through one geometry batch
+	// per atlas page; the vertices are rebuilt only when the text, origin or color change.
+	// Glyphs are laid out again when the atlas drops its cache (clear() or setRasterizer()).
+	class TextLayout
+	{
+	public:
+		struct Line
+		{
+			std::size_t first = 0; // index of the first glyph
+			int width = 0;
+		};
+
+		[[nodiscard]] explicit TextLayout(GlyphAtlas& atlas, int wrapWidth = 0)noexcept
+			: m_Atlas(&atlas)
+			, m_WrapWidth(wrapWidth)
+			, m_Generation(atlas.getGeneration())
+		{}
+
+		[[nodiscard]] TextLayout(GlyphAtlas& atlas, std::string_view text, int wrapWidth = 0)
+			: TextLayout(atlas, wrapWidth)
+		{
+			append(text);
+		}
+
+		void setText(std::string_view text)
+		{
+			clear();
+			append(text);
+		}
+
+		void append(std::string_view text)
+		{
+			m_Text.append(text);
+			if (m_Lines.empty())
+			{
+				m_Lines.push_back(Line{});
+			}
+			for (std::size_t position = 0; position < text.size();)
+			{
+				place(decodeUTF8(text, position));
+			}
+			m_Dirty = true;
+		}
+
+		void setWrapWidth(int wrapWidth)
+		{
+			if (wrapWidth != m_WrapWidth)
+			{
+				m_WrapWidth = wrapWidth;
+				const std::string text = std::move(m_Text);
+				setText(text);
+			}
+		}
+
+		void clear()noexcept
+		{
+			m_Text.clear();
+			m_Glyphs.clear();
+			m_Lines.clear();
+			m_PenX = 0;
+			m_Previous = 0;
+			m_Break = NO_BREAK;
+			m_ClosedWidth = 0;
+			m_Generation = m_Atlas->getGeneration();
+			m_Dirty = true;
+		}
+
+		[[nodiscard]] SDL_Point getSize()const noexcept
+		{
+			if (m_Lines.empty())
+			{
+				return SDL_Point{ 0, 0 };
+			}
+			const int lines = static_cast<int>(m_Lines.size());
+			return SDL_Point{ std::max(m_ClosedWidth, m_Lines.back().width), (lines - 1) * m_Atlas->getLineSkip() + m_Atlas->getHeight() };
+		}
+
+		[[nodiscard]] const std::vector<Line>& getLines()const noexcept { return m_Lines; }
+
+		[[nodiscard]] std::size_t getGlyphsCount()const noexcept { return m_Glyphs.size(); }
+
+		[[nodiscard]] const std::string& getText()const noexcept { return m_Text; }
+
+		[[nodiscard]] int getWrapWidth()const noexcept { return m_WrapWidth; }
+
+		[[nodiscard]] GlyphAtlas& getAtlas()const noexcept { return *m_Atlas; }
+
+		bool render(sdl2::Renderer& renderer, SDL_FPoint origin, SDL_Color color)
+		{
+			if (m_Generation != m_Atlas->getGeneration())
+			{
+				const std::string text = std::move(m_Text);
+				setText(text);
+			}
+			if (m_Dirty || origin.x != m_Origin.x || origin.y != m_Origin.y
+				|| color.r != m_Color.r || color.g != m_Color.g || color.b != m_Color.b || color.a != m_Color.a)
+			{
+				m_Origin = origin;
+				m_Color = color;
+				build();
+			}
+			bool success = true;
+			for (std::size_t page = 0; page < m_Batches.size(); ++page)
+			{
+				const Batch& batch = m_Batches[page];
+				if (batch.isEmpty())
+				{
+					continue;
+				}
+				SDL_Texture* texture = m_Atlas->getPage(static_cast<int>(page));
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+				success &= renderer.drawGeometry(texture, batch.vertices.data(), static_cast<int>(batch.vertices.size()), batch.indices.data(), static_cast<int>(batch.indices.size()));
+#else
+				SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+				SDL_SetTextureAlphaMod(texture, color.a);
+				for (const auto& [source, destination] : batch.quads)
+				{
+					success &= renderer.draw(texture, source, destination);
+				}
+#endif
+			}
+			return success;
+		}
+
+	private:
+		static constexpr std::size_t NO_BREAK = static_cast<std::size_t>(-1);
+
+		struct Glyph
+		{
+			AtlasGlyph glyph;
+			int x = 0;
+			int line = 0;
+			bool isSpace = false;
+		};
+
+		struct Batch
+		{
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+			std::vector<SDL_Vertex> vertices;
+			std::vector<int> indices;
+
+			[[nodiscard]] bool isEmpty()const noexcept { return vertices.empty(); }
+#else
+			std::vector<std::pair<SDL_Rect, SDL_FRect>> quads;
+
+			[[nodiscard]] bool isEmpty()const noexcept { return quads.empty(); }
+#endif
+		};
+
+		[[nodiscard]] static constexpr bool isSpace(char32_t codepoint)noexcept { return codepoint == U' ' || codepoint == U'\t' || codepoint == 0x3000; }
+
+		void place(char32_t codepoint)
+		{
+			if (codepoint == U'\n')
+			{
+				newLine(m_Glyphs.size());
+				return;
+			}
+			if (codepoint == U'\r')
+			{
+				return;
+			}
+			const AtlasGlyph* atlasGlyph = m_Atlas->find(codepoint);
+			if (atlasGlyph == nullptr)
+			{
+				atlasGlyph = m_Atlas->find(REPLACEMENT_CHARACTER);
+				if (atlasGlyph == nullptr)
+				{
+					return;
+				}
+				codepoint = REPLACEMENT_CHARACTER;
+			}
+			const bool space = isSpace(codepoint);
+			int x = m_PenX + (m_Previous != 0 ? m_Atlas->getKerning(m_Previous, codepoint) : 0);
+			if (m_WrapWidth > 0 && !space && x + atlasGlyph->advance > m_WrapWidth && m_Glyphs.size() > m_Lines.back().first)
+			{
+				if (m_Break != NO_BREAK && m_Break > m_Lines.back().first && m_Break < m_Glyphs.size())
+				{
+					// Move the word being typed to the next line.
+					const int shift = m_Glyphs[m_Break].x;
+					const int penX = m_PenX;
+					const char32_t previous = m_Previous;
+					newLine(m_Break);
+					for (std::size_t i = m_Lines.back().first; i < m_Glyphs.size(); ++i)
+					{
+						m_Glyphs[i].x -= shift;
+						m_Glyphs[i].line = static_cast<int>(m_Lines.size()) - 1;
+						if (!m_Glyphs[i].isSpace)
+						{
+							m_Lines.back().width = std::max(m_Lines.back().width, m_Glyphs[i].x + m_Glyphs[i].glyph.advance);
+						}
+					}
+					m_PenX = std::max(penX - shift, 0);
+					m_Previous = previous;
+					x = m_PenX + m_Atlas->getKerning(previous, codepoint);
+				}
+				else
+				{
+					newLine(m_Glyphs.size());
+					x = 0;
+				}
+			}
+			m_Glyphs.push_back(Glyph{ *atlasGlyph, x, static_cast<int>(m_Lines.size()) - 1, space });
+			m_PenX = x + atlasGlyph->advance;
+			m_Previous = codepoint;
+			if (space)
+			{
+				m_Break = m_Glyphs.size();
+			}
+			else
+			{
+				m_Lines.back().width = std::max(m_Lines.back().width, m_PenX);
+			}
+		}
+
+		// Closes the current line at glyph first and opens a new one starting there.
+		void newLine(std::size_t first)
+		{
+			Line& line = m_Lines.back();
+			line.width = 0;
+			for (std::size_t i = line.first; i < first; ++i)
+			{
+				if (!m_Glyphs[i].isSpace)
+				{
+					line.width = std::max(line.width, m_Glyphs[i].x + m_Glyphs[i].glyph.advance);
+				}
+			}
+			m_ClosedWidth = std::max(m_ClosedWidth, line.width);
+			m_Lines.push_back(Line{ first, 0 });
+			m_PenX = 0;
+			m_Previous = 0;
+			m_Break = NO_BREAK;
+		}
+
+		void build()
+		{
+			m_Batches.assign(static_cast<std::size_t>(m_Atlas->getPagesCount()), Batch{});
+			const int lineSkip = m_Atlas->getLineSkip();
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+			const auto pageSize = static_cast<float>(m_Atlas->getPageSize());
+#endif
+			for (const Glyph& glyph : m_Glyphs)
+			{
+				const AtlasGlyph& g = glyph.glyph;
+				if (g.page < 0)
+				{
+					continue;
+				}
+				Batch& batch = m_Batches[static_cast<std::size_t>(g.page)];
+				const SDL_FRect destination{ m_Origin.x + static_cast<float>(glyph.x + g.offsetX), m_Origin.y + static_cast<float>(glyph.line * lineSkip),
+					static_cast<float>(g.rect.w), static_cast<float>(g.rect.h) };
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+				const float u0 = static_cast<float>(g.rect.x) / pageSize;
+				const float v0 = static_cast<float>(g.rect.y) / pageSize;
+				const float u1 = static_cast<float>(g.rect.x + g.rect.w) / pageSize;
+				const float v1 = static_cast<float>(g.rect.y + g.rect.h) / pageSize;
+				const int base = static_cast<int>(batch.vertices.size());
+				batch.vertices.push_back(SDL_Vertex{ { destination.x, destination.y }, m_Color, { u0, v0 } });
+				batch.vertices.push_back(SDL_Vertex{ { destination.x + destination.w, destination.y }, m_Color, { u1, v0 } });
+				batch.vertices.push_back(SDL_Vertex{ { destination.x + destination.w, destination.y + destination.h }, m_Color, { u1, v1 } });
+				batch.vertices.push_back(SDL_Vertex{ { destination.x, destination.y + destination.h }, m_Color, { u0, v1 } });
+				for (const int index : { 0, 1, 2, 0, 2, 3 })
+				{
+					batch.indices.push_back(base + index);
+				}
+#else
+				batch.quads.emplace_back(g.rect, destination);
+#endif
+			}
+			m_Dirty = false;
+		}
+
+		GlyphAtlas* m_Atlas;
+		int m_WrapWidth;
+		std::string m_Text;
+		std::vector<Glyph> m_Glyphs;
+		std::vector<Line> m_Lines;
+		int m_PenX = 0;
+		char32_t m_Previous = 0;
+		std::size_t m_Break = NO_BREAK;
+		int m_ClosedWidth = 0;
+		std::uint32_t m_Generation;
+
+		std::vector<Batch> m_Batches;
+		SDL_FPoint m_Origin{ 0.0f, 0.0f };
+		SDL_Color m_Color{ 255, 255, 255, 255 };
+		bool m_Dirty = true;
+	};
+
+	// Keeps layouts of recently drawn strings keyed by (text hash, atlas, wrap width); the atlas
+	// stands for the font and its size.
+	// Call nextFrame() once per frame; layouts not requested for maxUnusedFrames are dropped, and so
+	// are layouts whose atlas has dropped its glyphs since they were built.
+	class TextLayoutCache
+	{
+	public:
+		[[nodiscard]] explicit TextLayoutCache(std::uint32_t maxUnusedFrames = 60)noexcept
+			: m_MaxUnusedFrames(maxUnusedFrames)
+		{}
+
+		TextLayout& get(GlyphAtlas& atlas, std::string_view text, int wrapWidth = 0)
+		{
+			const Key key{ std::hash<std::string_view>{}(text), &atlas, wrapWidth };
+			auto it = m_Entries.find(key);
+			if (it != m_Entries.end() && it->second.generation == atlas.getGeneration() && it->second.layout.getText() == text)
+			{
+				++m_Hits;
+			}
+			else
+			{
+				++m_Misses;
+				it = m_Entries.insert_or_assign(key, Entry{ TextLayout{ atlas, text, wrapWidth }, m_Frame, atlas.getGeneration() }).first;
+			}
+			it->second.frame = m_Frame;
+			return it->second.layout;
+		}
+
+		void nextFrame()
+		{
+			++m_Frame;
+			for (auto it = m_Entries.begin(); it != m_Entries.end();)
+			{
+				const Entry& entry = it->second;
+				const bool isStale = entry.generation != entry.layout.getAtlas().getGeneration();
+				it = isStale || m_Frame - entry.frame > m_MaxUnusedFrames ? m_Entries.erase(it) : std::next(it);
+			}
+		}
+
+		void clear()noexcept { m_Entries.clear(); }
+
+		[[nodiscard]] std::size_t getSize()const noexcept { return m_Entries.size(); }
+
+		[[nodiscard]] std::uint64_t getHits()const noexcept { return m_Hits; }
+
+		[[nodiscard]] std::uint64_t getMisses()const noexcept { return m_Misses; }
+
+	private:
+		struct Key
+		{
+			std::size_t hash = 0;
+			const GlyphAtlas* atlas = nullptr;
+			int width = 0;
+
+			[[nodiscard]] bool operator==(const Key& other)const noexcept { return hash == other.hash && atlas == other.atlas && width == other.width; }
+		};
+
+		struct KeyHash
+		{
+			[[nodiscard]] std::size_t operator()(const Key& key)const noexcept
+			{
+				return key.hash ^ (std::hash<const void*>{}(key.atlas) << 1) ^ (std::hash<int>{}(key.width) << 2);
+			}
+		};
+
+		struct Entry
+		{
+			TextLayout layout;
+			std::uint32_t frame = 0;
+			std::uint32_t generation = 0;
+		};
+
+		std::unordered_map<Key, Entry, KeyHash> m_Entries;
+		std::uint32_t m_MaxUnusedFrames;
+		std::uint32_t m_Frame = 0;
+		std::uint64_t m_Hits = 0;
+		std::uint64_t m_Misses = 0;
+	};
+}
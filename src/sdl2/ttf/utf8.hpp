@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sdl2::ttf
+{
+	constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+	// Decodes the code point starting at position and advances past it.
+	// Malformed sequences yield REPLACEMENT_CHARACTER and skip a single byte.
+	[[nodiscard]] constexpr char32_t decodeUTF8(std::string_view text, std::size_t& position)noexcept
+	{
+		const auto lead = static_cast<std::uint8_t>(text[position++]);
+		if (lead < 0x80)
+		{
+			return lead;
+		}
+		int length = 0;
+		char32_t codepoint = 0;
+		if ((lead & 0xE0) == 0xC0) { length = 1; codepoint = lead & 0x1Fu; }
+		else if ((lead & 0xF0) == 0xE0) { length = 2; codepoint = lead & 0x0Fu; }
+		else if ((lead & 0xF8) == 0xF0) { length = 3; codepoint = lead & 0x07u; }
+		else { return REPLACEMENT_CHARACTER; }
+
+		if (position + static_cast<std::size_t>(length) > text.size())
+		{
+			return REPLACEMENT_CHARACTER;
+		}
+		for (int i = 0; i < length; ++i)
+		{
+			const auto next = static_cast<std::uint8_t>(text[position + static_cast<std::size_t>(i)]);
+			if ((next & 0xC0) != 0x80)
+			{
+				return REPLACEMENT_CHARACTER;
+			}
+			codepoint = (codepoint << 6) | (next & 0x3Fu);
+		}
+		position += static_cast<std::size_t>(length);
+		constexpr char32_t minimum[] = { 0, 0x80, 0x800, 0x10000 };
+		if (codepoint < minimum[length] || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+		{
+			return REPLACEMENT_CHARACTER;
+		}
+		return codepoint;
+	}
+
+	// Appends the decoded code points to codepoints, which callers keep around to avoid allocating.
+	inline void decodeUTF8(std::string_view text, std::u32string& codepoints)
+	{
+		for (std::size_t position = 0; position < text.size();)
+		{
+			codepoints.push_back(decodeUTF8(text, position));
+		}
+	}
+
+	inline void appendUTF8(std::string& text, char32_t codepoint)
+	{
+		if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+		{
+			codepoint = REPLACEMENT_CHARACTER;
+		}
+		if (codepoint < 0x80)
+		{
+			text.push_back(static_cast<char>(codepoint));
+		}
+		else if (codepoint < 0x800)
+		{
+			text.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+			text.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+		}
+		else if (codepoint < 0x10000)
+		{
+			text.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+			text.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+			text.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+		}
+		else
+		{
+			text.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+			text.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+			text.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+			text.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+		}
+	}
+}
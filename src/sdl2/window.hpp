@@ -11,6 +11,7 @@
 #include <utility>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace sdl2
 {
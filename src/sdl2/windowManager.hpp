@@ -0,0 +1,371 @@
+#pragma once
+
+#include "events.hpp"
+#include "renderer.hpp"
+#include "window.hpp"
+
+#include <SDL_events.h>
+#include <SDL_version.h>
+#include <SDL_video.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sdl2
+{
+	enum class RefreshPolicy
+	{
+		ON_DEMAND,  // redrawn only after invalidate() or when the system asks for it
+		FIXED_RATE, // redrawn at its own rate, the display refresh rate by default
+		VSYNC       // redrawn every frame, presents with vsync
+	};
+
+	// Window id an event is addressed to, 0 for events that are not tied to a window.
+	[[nodiscard]] inline std::uint32_t getWindowId(const SDL_Event& event)noexcept
+	{
+		switch (event.type)
+		{
+		case SDL_WINDOWEVENT: return event.window.windowID;
+		case SDL_KEYDOWN:
+		case SDL_KEYUP: return event.key.windowID;
+		case SDL_TEXTEDITING: return event.edit.windowID;
+		case SDL_TEXTINPUT: return event.text.windowID;
+		case SDL_MOUSEMOTION: return event.motion.windowID;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP: return event.button.windowID;
+		case SDL_MOUSEWHEEL: return event.wheel.windowID;
+		case SDL_DROPFILE:
+		case SDL_DROPTEXT:
+		case SDL_DROPBEGIN:
+		case SDL_DROPCOMPLETE: return event.drop.windowID;
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+		case SDL_FINGERDOWN:
+		case SDL_FINGERUP:
+		case SDL_FINGERMOTION: return event.tfinger.windowID;
+#endif
+		default: return event.type >= SDL_USEREVENT ? event.user.windowID : 0;
+		}
+	}
+
+	class WindowManager;
+
+	// Window and renderer pair owned by a WindowManager.
+	class ManagedWindow
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+		using OnEvent = std::function<void(ManagedWindow&, const SDL_Event&)>;
+		using OnDraw = std::function<void(ManagedWindow&)>;
+
+		ManagedWindow(const ManagedWindow&) = delete;
+		ManagedWindow& operator=(const ManagedWindow&) = delete;
+
+		[[nodiscard]] sdl2::Window& getWindow()noexcept { return m_Window; }
+
+		[[nodiscard]] sdl2::Renderer& getRenderer()noexcept { return m_Renderer; }
+
+		[[nodiscard]] std::uint32_t getId()const noexcept { return m_Id; }
+
+		[[nodiscard]] RefreshPolicy getPolicy()const noexcept { return m_Policy; }
+
+		[[nodiscard]] bool isVisible()const noexcept { return m_IsVisible; }
+
+		[[nodiscard]] bool isDirty()const noexcept { return m_IsDirty; }
+
+		[[nodiscard]] std::uint64_t getFramesCount()const noexcept { return m_FramesCount; }
+
+		// Asks for a redraw of an ON_DEMAND window.
+		void invalidate()noexcept { m_IsDirty = true; }
+
+		// Set when the user closes the window; the manager destroys it after dispatching the event
+		// unless the event handler cancels.
+		[[nodiscard]] bool isCloseRequested()const noexcept { return m_IsCloseRequested; }
+
+		void cancelClose()noexcept { m_IsCloseRequested = false; }
+
+		void setEventHandler(OnEvent onEvent) { m_OnEvent = std::move(onEvent); }
+
+		void setDrawHandler(OnDraw onDraw) { m_OnDraw = std::move(onDraw); }
+
+		// A rate of 0 follows the refresh rate of the display the window is on.
+		void setPolicy(RefreshPolicy policy, double rate = 0.0)
+		{
+			m_Policy = policy;
+			m_Rate = rate;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+			m_Renderer.setVSync(policy == RefreshPolicy::VSYNC);
+#endif
+			updateInterval();
+			m_NextFrame = Clock::now();
+			m_IsDirty = true;
+		}
+
+	private:
+		friend class WindowManager;
+
+		ManagedWindow(sdl2::Window window, sdl2::Renderer renderer, RefreshPolicy policy, double rate)
+			: m_Window(std::move(window))
+			, m_Renderer(std::move(renderer))
+			, m_Id(m_Window.getId())
+			, m_IsVisible((m_Window.getFlags() & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED)) == 0)
+		{
+			setPolicy(policy, rate);
+		}
+
+		void updateInterval()
+		{
+			double rate = m_Rate;
+			if (rate <= 0.0)
+			{
+				const std::optional<SDL_DisplayMode> mode = m_Window.getDisplayMode();
+				rate = mode && mode->refresh_rate > 0 ? static_cast<double>(mode->refresh_rate) : 60.0;
+			}
+			m_Interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+		}
+
+		[[nodiscard]] bool isDue(Clock::time_point now)const noexcept
+		{
+			if (!m_IsVisible)
+			{
+				return false;
+			}
+			switch (m_Policy)
+			{
+			case RefreshPolicy::ON_DEMAND: return m_IsDirty;
+			case RefreshPolicy::FIXED_RATE: return m_IsDirty || now >= m_NextFrame;
+			case RefreshPolicy::VSYNC: return true;
+			}
+			return false;
+		}
+
+		void handle(const SDL_Event& event)
+		{
+			if (event.type == SDL_WINDOWEVENT)
+			{
+				switch (event.window.event)
+				{
+				case SDL_WINDOWEVENT_SHOWN:
+				case SDL_WINDOWEVENT_RESTORED:
+				case SDL_WINDOWEVENT_MAXIMIZED:
+				case SDL_WINDOWEVENT_EXPOSED:
+				case SDL_WINDOWEVENT_SIZE_CHANGED:
+					m_IsVisible = true;
+					m_IsDirty = true;
+					break;
+				case SDL_WINDOWEVENT_HIDDEN:
+				case SDL_WINDOWEVENT_MINIMIZED:
+					m_IsVisible = false;
+					break;
+				case SDL_WINDOWEVENT_MOVED:
+					// The window may now be on a display with another refresh rate.
+					updateInterval();
+					break;
+				case SDL_WINDOWEVENT_CLOSE:
+					m_IsCloseRequested = true;
+					break;
+				default:
+					break;
+				}
+			}
+			if (m_OnEvent)
+			{
+				m_OnEvent(*this, event);
+			}
+		}
+
+		void draw(Clock::time_point now)
+		{
+			if (m_OnDraw)
+			{
+				m_OnDraw(*this);
+			}
+			m_Renderer.present();
+			m_IsDirty = false;
+			// A late frame does not cause a burst of catch-up frames.
+			m_NextFrame = std::max(m_NextFrame + m_Interval, now);
+			++m_FramesCount;
+		}
+
+		sdl2::Window m_Window;
+		sdl2::Renderer m_Renderer;
+		std::uint32_t m_Id = 0;
+		RefreshPolicy m_Policy = RefreshPolicy::ON_DEMAND;
+		double m_Rate = 0.0;
+		Clock::duration m_Interval{ 0 };
+		Clock::time_point m_NextFrame;
+		std::uint64_t m_FramesCount = 0;
+		bool m_IsVisible = true;
+		bool m_IsDirty = true;
+		bool m_IsCloseRequested = false;
+		OnEvent m_OnEvent;
+		OnDraw m_OnDraw;
+	};
+
+	// Owns several Window and Renderer pairs, routes events to them by windowID in one pass over
+	// the queue and redraws each one according to its own RefreshPolicy. Hidden and minimized
+	// windows are never drawn, idle ON_DEMAND windows cost nothing, and VSYNC windows present
+	// last so that waiting for one display does not delay the other windows. Keep at most one
+	// window on VSYNC; the others follow their display rate with FIXED_RATE.
+	class WindowManager
+	{
+	public:
+		using Clock = ManagedWindow::Clock;
+		using OnEvent = std::function<void(const SDL_Event&)>;
+
+		[[nodiscard]] WindowManager() = default;
+
+		WindowManager(const WindowManager&) = delete;
+		WindowManager& operator=(const WindowManager&) = delete;
+
+		// Returns nullptr if the window or its renderer could not be created.
+		ManagedWindow* create(const std::string& title, int w, int h, WindowFlags windowFlags = WindowFlags::SHOWN | WindowFlags::RESIZABLE,
+			RefreshPolicy policy = RefreshPolicy::ON_DEMAND, double rate = 0.0, RendererFlags rendererFlags = RendererFlags::ACCELERATED)
+		{
+			sdl2::Window window{ title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, w, h, windowFlags };
+			if (!window.isValid())
+			{
+				return nullptr;
+			}
+#if !SDL_VERSION_ATLEAST(2, 0, 18)
+			// Without SDL_RenderSetVSync the choice is made once, at creation.
+			if (policy == RefreshPolicy::VSYNC)
+			{
+				rendererFlags = rendererFlags | RendererFlags::PRESENTVSYNC;
+			}
+#endif
+			sdl2::Renderer renderer{ window.get(), rendererFlags };
+			if (!renderer.isValid())
+			{
+				return nullptr;
+			}
+			m_Windows.push_back(std::unique_ptr<ManagedWindow>{ new ManagedWindow{ std::move(window), std::move(renderer), policy, rate } });
+			return m_Windows.back().get();
+		}
+
+		bool destroy(std::uint32_t id)
+		{
+			const auto it = std::find_if(m_Windows.begin(), m_Windows.end(), [id](const auto& window) { return window->getId() == id; });
+			if (it == m_Windows.end())
+			{
+				return false;
+			}
+			m_Windows.erase(it);
+			return true;
+		}
+
+		[[nodiscard]] ManagedWindow* find(std::uint32_t id)noexcept
+		{
+			// A handful of windows; a linear scan beats hashing.
+			for (const auto& window : m_Windows)
+			{
+				if (window->getId() == id)
+				{
+					return window.get();
+				}
+			}
+			return nullptr;
+		}
+
+		// Receives the events that are not addressed to a managed window, e.g. SDL_QUIT.
+		void setEventHandler(OnEvent onEvent) { m_OnEvent = std::move(onEvent); }
+
+		void dispatch(const SDL_Event& event)
+		{
+			const std::uint32_t id = getWindowId(event);
+			if (ManagedWindow* window = id != 0 ? find(id) : nullptr; window != nullptr)
+			{
+				window->handle(event);
+			}
+			else if (m_OnEvent)
+			{
+				m_OnEvent(event);
+			}
+		}
+
+		// Dispatches every pending event, then destroys the windows whose close was not cancelled.
+		void pollEvents()
+		{
+			SDL_Event event;
+			while (sdl2::events::poll(event))
+			{
+				dispatch(event);
+			}
+			destroyClosed();
+		}
+
+		// Draws and presents the windows that are due; returns how many were drawn.
+		std::size_t render()
+		{
+			const Clock::time_point now = Clock::now();
+			std::size_t drawn = 0;
+			for (const bool isVSyncPass : { false, true })
+			{
+				for (const auto& window : m_Windows)
+				{
+					if ((window->getPolicy() == RefreshPolicy::VSYNC) == isVSyncPass && window->isDue(now))
+					{
+						window->draw(now);
+						++drawn;
+					}
+				}
+			}
+			return drawn;
+		}
+
+		// Earliest moment a window needs drawing; std::nullopt when every window is idle or hidden.
+		[[nodiscard]] std::optional<Clock::time_point> getNextDeadline()const noexcept
+		{
+			std::optional<Clock::time_point> deadline;
+			for (const auto& window : m_Windows)
+			{
+				if (!window->m_IsVisible)
+				{
+					continue;
+				}
+				std::optional<Clock::time_point> next;
+				if (window->m_IsDirty || window->m_Policy == RefreshPolicy::VSYNC)
+				{
+					next = Clock::time_point::min();
+				}
+				else if (window->m_Policy == RefreshPolicy::FIXED_RATE)
+				{
+					next = window->m_NextFrame;
+				}
+				if (next && (!deadline || *next < *deadline))
+				{
+					deadline = next;
+				}
+			}
+			return deadline;
+		}
+
+		void invalidateAll()noexcept
+		{
+			for (const auto& window : m_Windows)
+			{
+				window->invalidate();
+			}
+		}
+
+		[[nodiscard]] bool isEmpty()const noexcept { return m_Windows.empty(); }
+
+		[[nodiscard]] std::size_t getSize()const noexcept { return m_Windows.size(); }
+
+		[[nodiscard]] const std::vector<std::unique_ptr<ManagedWindow>>& getWindows()const noexcept { return m_Windows; }
+
+		// Destroys the windows whose close request was not cancelled by their event handler.
+		void destroyClosed()
+		{
+			m_Windows.erase(std::remove_if(m_Windows.begin(), m_Windows.end(), [](const auto& window) { return window->isCloseRequested(); }), m_Windows.end());
+		}
+
+	private:
+		std::vector<std::unique_ptr<ManagedWindow>> m_Windows;
+		OnEvent m_OnEvent;
+	};
+}
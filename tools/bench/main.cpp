@@ -0,0 +1,317 @@
+// sdl2-hpp-bench: micro benchmarks of the CPU side helpers.
+//
+// usage: sdl2-hpp-bench [filter] [--repeat N]
+//   filter              run only the benchmarks whose name contains it
+//   --repeat N          timed repetitions per case (default: 50)
+//
+// Each case is run once to warm up and then timed; the tables report the mean per repetition.
+// Inputs come from a fixed seed so runs are comparable between builds.
+
+#include "sdl2/spanSprite.hpp"
+#include "sdl2/spatialGrid.hpp"
+#include "sdl2/surface.hpp"
+
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct Options
+	{
+		std::string_view filter;
+		int repeat = 50;
+	};
+
+	// Mean microseconds of one call of run over options.repeat timed calls.
+	template<class Run>
+	[[nodiscard]] double measure(const Options& options, Run&& run)
+	{
+		run();
+		const Clock::time_point start = Clock::now();
+		for (int i = 0; i < options.repeat; ++i)
+		{
+			run();
+		}
+		return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / static_cast<double>(options.repeat);
+	}
+
+	// Keeps results alive so the optimizer cannot drop the measured work.
+	std::uint64_t g_Sink = 0;
+
+	constexpr float SPRITE_SIZE = 32.0f;
+	constexpr SDL_FRect VIEWPORT{ 0.0f, 0.0f, 1920.0f, 1080.0f };
+	// World area per object, about 200 objects on a 1080p screen.
+	constexpr float AREA_PER_ITEM = VIEWPORT.w * VIEWPORT.h / 200.0f;
+
+	struct World
+	{
+		std::vector<SDL_FRect> bounds;
+		sdl2::SpatialGrid grid;
+		std::vector<sdl2::SpatialGrid::Handle> handles;
+		float side = 0.0f;
+	};
+
+	[[nodiscard]] World makeWorld(std::size_t count, std::mt19937& random)
+	{
+		World world;
+		world.side = std::sqrt(static_cast<float>(count) * AREA_PER_ITEM);
+		std::uniform_real_distribution<float> position{ 0.0f, world.side - SPRITE_SIZE };
+		world.bounds.reserve(count);
+		world.handles.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const SDL_FRect bounds{ position(random), position(random), SPRITE_SIZE, SPRITE_SIZE };
+			world.bounds.push_back(bounds);
+			world.handles.push_back(world.grid.insert(bounds, static_cast<std::uint32_t>(i)));
+		}
+		return world;
+	}
+
+	// Viewports of the given size spread over the world, one per repetition.
+	[[nodiscard]] std::vector<SDL_FRect> makeViews(const World& world, float w, float h, std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> x{ 0.0f, std::max(world.side - w, 0.0f) };
+		std::uniform_real_distribution<float> y{ 0.0f, std::max(world.side - h, 0.0f) };
+		std::vector<SDL_FRect> views(64);
+		for (SDL_FRect& view : views)
+		{
+			view = SDL_FRect{ x(random), y(random), w, h };
+		}
+		return views;
+	}
+
+	[[nodiscard]] bool intersects(const SDL_FRect& a, const SDL_FRect& b)noexcept
+	{
+		return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+	}
+
+	struct CullResult
+	{
+		double visible = 0.0;
+		double gridUs = 0.0;
+		double scanUs = 0.0;
+	};
+
+	// Grid query against testing every box, averaged over the views.
+	[[nodiscard]] CullResult cull(const Options& options, World& world, const std::vector<SDL_FRect>& views)
+	{
+		CullResult result;
+		std::vector<std::uint32_t> visible;
+		std::size_t totalVisible = 0;
+		std::size_t view = 0;
+		result.gridUs = measure(options, [&]
+		{
+			visible.clear();
+			totalVisible += world.grid.query(views[view++ % views.size()], visible);
+		});
+		result.visible = static_cast<double>(totalVisible) / static_cast<double>(options.repeat + 1);
+		view = 0;
+		result.scanUs = measure(options, [&]
+		{
+			const SDL_FRect& area = views[view++ % views.size()];
+			std::size_t count = 0;
+			for (const SDL_FRect& bounds : world.bounds)
+			{
+				count += intersects(bounds, area) ? 1u : 0u;
+			}
+			g_Sink += count;
+		});
+		return result;
+	}
+
+	void benchSpatialGrid(const Options& options)
+	{
+		std::mt19937 random{ 1234 };
+
+		std::printf("spatial grid: fixed 1920x1080 view, world grows at constant density\n");
+		std::printf("%10s %10s %12s %12s\n", "items", "visible", "query us", "scan us");
+		for (const std::size_t count : { 10000u, 100000u, 1000000u })
+		{
+			World world = makeWorld(count, random);
+			const CullResult result = cull(options, world, makeViews(world, VIEWPORT.w, VIEWPORT.h, random));
+			std::printf("%10zu %10.0f %12.2f %12.2f\n", count, result.visible, result.gridUs, result.scanUs);
+		}
+
+		std::printf("\nspatial grid: 100000 items, view grows\n");
+		std::printf("%10s %10s %12s %12s\n", "view", "visible", "query us", "scan us");
+		World world = makeWorld(100000, random);
+		for (const float scale : { 0.25f, 0.5f, 1.0f, 2.0f, 4.0f })
+		{
+			const float w = VIEWPORT.w * scale;
+			const float h = VIEWPORT.h * scale;
+			const CullResult result = cull(options, world, makeViews(world, w, h, random));
+			std::printf("%4.0fx%-5.0f %10.0f %12.2f %12.2f\n", static_cast<double>(w), static_cast<double>(h), result.visible, result.gridUs, result.scanUs);
+		}
+
+		// A tenth of the objects drift by a few pixels each frame.
+		std::uniform_real_distribution<float> step{ -4.0f, 4.0f };
+		const std::size_t moved = world.handles.size() / 10;
+		std::size_t first = 0;
+		const double updateUs = measure(options, [&]
+		{
+			for (std::size_t i = 0; i < moved; ++i)
+			{
+				const std::size_t index = (first + i) % world.handles.size();
+				SDL_FRect& bounds = world.bounds[index];
+				bounds.x = std::clamp(bounds.x + step(random), 0.0f, world.side - SPRITE_SIZE);
+				bounds.y = std::clamp(bounds.y + step(random), 0.0f, world.side - SPRITE_SIZE);
+				world.grid.update(world.handles[index], bounds);
+			}
+			first += moved;
+		});
+		std::printf("\nspatial grid: %zu updates per frame, %.2f us (%.1f ns each)\n", moved, updateUs, updateUs * 1000.0 / static_cast<double>(moved));
+	}
+
+	constexpr int SPRITE_SIDE = 128;
+	constexpr int SPRITES_PER_FRAME = 200;
+
+	// ARGB8888 disc of the given radius with a one pixel translucent edge, transparent around it.
+	[[nodiscard]] sdl2::Surface makeDisc(float radius)
+	{
+		sdl2::Surface surface{ 0, SPRITE_SIDE, SPRITE_SIDE, 32, SDL_PIXELFORMAT_ARGB8888 };
+		if (!surface.isValid())
+		{
+			return surface;
+		}
+		const float center = static_cast<float>(SPRITE_SIDE) * 0.5f;
+		auto* pixels = static_cast<std::uint8_t*>(surface.getPixels());
+		for (int y = 0; y < SPRITE_SIDE; ++y)
+		{
+			auto* row = reinterpret_cast<std::uint32_t*>(pixels + static_cast<std::ptrdiff_t>(y) * surface.getPitch());
+			for (int x = 0; x < SPRITE_SIDE; ++x)
+			{
+				const float dx = static_cast<float>(x) + 0.5f - center;
+				const float dy = static_cast<float>(y) + 0.5f - center;
+				const float coverage = std::clamp(radius - std::sqrt(dx * dx + dy * dy) + 0.5f, 0.0f, 1.0f);
+				const auto alpha = static_cast<std::uint32_t>(coverage * 255.0f + 0.5f);
+				row[x] = (alpha << 24) | (static_cast<std::uint32_t>(x * 2) << 16) | (static_cast<std::uint32_t>(y * 2) << 8) | 0x40u;
+			}
+		}
+		surface.setBlendMode(SDL_BLENDMODE_BLEND);
+		return surface;
+	}
+
+	// SPRITES_PER_FRAME blits per repetition into a 1080p ARGB8888 target, by SDL with and
+	// without RLE acceleration and by SpanSprite.
+	void benchSpanSprite(const Options& options)
+	{
+		std::mt19937 random{ 1234 };
+		std::uniform_int_distribution<int> x{ -SPRITE_SIDE / 2, static_cast<int>(VIEWPORT.w) - SPRITE_SIDE / 2 };
+		std::uniform_int_distribution<int> y{ -SPRITE_SIDE / 2, static_cast<int>(VIEWPORT.h) - SPRITE_SIDE / 2 };
+		std::vector<SDL_Point> positions(SPRITES_PER_FRAME);
+		for (SDL_Point& position : positions)
+		{
+			position = SDL_Point{ x(random), y(random) };
+		}
+		sdl2::Surface target{ 0, static_cast<int>(VIEWPORT.w), static_cast<int>(VIEWPORT.h), 32, SDL_PIXELFORMAT_ARGB8888 };
+		if (!target.isValid())
+		{
+			std::printf("span sprite: no target surface (%s)\n", SDL_GetError());
+			return;
+		}
+
+		std::printf("span sprite: %d %dx%d sprites per frame into %dx%d ARGB8888\n", SPRITES_PER_FRAME, SPRITE_SIDE, SPRITE_SIDE, target.getWidth(), target.getHeight());
+		std::printf("%8s %10s %12s %12s %12s %10s\n", "covered", "runs", "blit us", "rle us", "span us", "span KiB");
+		for (const float radius : { 16.0f, 40.0f, 64.0f, 96.0f })
+		{
+			sdl2::Surface plain = makeDisc(radius);
+			sdl2::Surface rle = makeDisc(radius);
+			const sdl2::SpanSprite sprite = sdl2::SpanSprite::encode(plain);
+			if (!plain.isValid() || !rle.isValid() || !sprite.isValid() || !rle.setRLE(true))
+			{
+				std::printf("span sprite: setup failed (%s)\n", SDL_GetError());
+				return;
+			}
+			const SDL_Rect source{ 0, 0, SPRITE_SIDE, SPRITE_SIDE };
+			const auto blitAll = [&](sdl2::Surface& surface)
+			{
+				for (const SDL_Point& position : positions)
+				{
+					SDL_Rect destination{ position.x, position.y, SPRITE_SIDE, SPRITE_SIDE };
+					sdl2::Surface::blit(surface, source, target, destination);
+				}
+			};
+			const double blitUs = measure(options, [&] { blitAll(plain); });
+			// The warm up call makes SDL build the RLE encoding before timing starts.
+			const double rleUs = measure(options, [&] { blitAll(rle); });
+			const double spanUs = measure(options, [&]
+			{
+				for (const SDL_Point& position : positions)
+				{
+					sprite.blit(target, position.x, position.y);
+				}
+			});
+			const double covered = static_cast<double>(sprite.getPixels().size()) * 100.0 / (SPRITE_SIDE * SPRITE_SIDE);
+			std::printf("%7.1f%% %10zu %12.2f %12.2f %12.2f %10.1f\n", covered, sprite.getRuns().size(), blitUs, rleUs, spanUs, static_cast<double>(sprite.getMemoryUsage()) / 1024.0);
+		}
+		g_Sink += static_cast<const std::uint32_t*>(target.getPixels())[0];
+	}
+
+	struct Benchmark
+	{
+		const char* name;
+		void(*run)(const Options&);
+	};
+
+	constexpr std::array<Benchmark, 2> BENCHMARKS{ {
+		{ "spatialGrid", &benchSpatialGrid },
+		{ "spanSprite", &benchSpanSprite },
+	} };
+
+	[[nodiscard]] std::optional<Options> parse(int argc, char** argv)
+	{
+		Options options;
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string_view arg = argv[i];
+			if (arg == "--repeat" && i + 1 < argc)
+			{
+				options.repeat = std::max(std::atoi(argv[++i]), 1);
+			}
+			else if (!arg.empty() && arg[0] != '-' && options.filter.empty())
+			{
+				options.filter = arg;
+			}
+			else
+			{
+				return std::nullopt;
+			}
+		}
+		return options;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::optional<Options> options = parse(argc, argv);
+	if (!options)
+	{
+		std::fprintf(stderr, "usage: %s [filter] [--repeat N]\n", argc > 0 ? argv[0] : "sdl2-hpp-bench");
+		return EXIT_FAILURE;
+	}
+	bool isFirst = true;
+	for (const Benchmark& benchmark : BENCHMARKS)
+	{
+		if (std::string_view{ benchmark.name }.find(options->filter) == std::string_view::npos)
+		{
+			continue;
+		}
+		std::printf(isFirst ? "== %s ==\n" : "\n== %s ==\n", benchmark.name);
+		benchmark.run(*options);
+		isFirst = false;
+	}
+	std::printf("\n(checksum %llu)\n", static_cast<unsigned long long>(g_Sink));
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,659 @@
+// sdl2-hpp-imgproc: batch image preprocessing on top of sdl2::Surface.
+//
+// usage: sdl2-hpp-imgproc <input dir> <output dir> [options]
+//   --jobs N            worker threads (default: hardware concurrency)
+//   --max-in-flight N   images resident at once, bounds peak memory (default: 2 * jobs)
+//   --format NAME       output pixel format: argb8888, abgr8888, rgba8888, rgb888, rgb565
+//   --trim              crop fully transparent borders
+//   --premultiply       multiply color channels by alpha
+//   --resize WxH        resize to an exact size
+//   --scale F           resize by a factor
+//   --jpg Q | --bmp     output encoding (default: png)
+//   --recursive         walk subdirectories, mirroring them in the output
+//
+// Files are discovered lazily and each one goes through load, convert, trim, premultiply,
+// resize and save as a single task on a work-stealing pool. Discovery stops while
+// max-in-flight images are being processed, so memory stays bounded however large the
+// input directory is. Per-stage timings are printed at the end.
+
+#include "sdl2/root.hpp"
+#include "sdl2/surface.hpp"
+#include "sdl2/image/root.hpp"
+
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifndef SDL2_ENABLE_IMG
+	#error sdl2-hpp-imgproc needs SDL2_ENABLE_IMG
+#endif
+
+namespace
+{
+	namespace fs = std::filesystem;
+	using Clock = std::chrono::steady_clock;
+
+	enum class Stage : std::size_t
+	{
+		LOAD,
+		CONVERT,
+		TRIM,
+		PREMULTIPLY,
+		RESIZE,
+		SAVE,
+		COUNT
+	};
+
+	constexpr std::array<const char*, static_cast<std::size_t>(Stage::COUNT)> STAGE_NAMES{ "load", "convert", "trim", "premultiply", "resize", "save" };
+
+	enum class Encoding
+	{
+		PNG,
+		JPG,
+		BMP
+	};
+
+	struct Options
+	{
+		fs::path input;
+		fs::path output;
+		unsigned jobs = std::max(std::thread::hardware_concurrency(), 1u);
+		std::size_t maxInFlight = 0;
+		std::uint32_t format = SDL_PIXELFORMAT_ARGB8888;
+		bool trim = false;
+		bool premultiply = false;
+		int width = 0;
+		int height = 0;
+		float scale = 1.0f;
+		Encoding encoding = Encoding::PNG;
+		int quality = 90;
+		bool recursive = false;
+	};
+
+	class StageTimings
+	{
+	public:
+		void add(Stage stage, Clock::duration elapsed)noexcept
+		{
+			Entry& entry = m_Entries[static_cast<std::size_t>(stage)];
+			const auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+			entry.total.fetch_add(ns, std::memory_order_relaxed);
+			entry.count.fetch_add(1, std::memory_order_relaxed);
+			std::uint64_t max = entry.max.load(std::memory_order_relaxed);
+			while (ns > max && !entry.max.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		// "busy %" is the share of the worker time, wall time times jobs, spent in each stage.
+		void print(double wallSeconds, unsigned jobs)const
+		{
+			const double workerMilliseconds = wallSeconds * 1000.0 * static_cast<double>(std::max(jobs, 1u));
+			std::printf("%-12s %10s %10s %10s %8s\n", "stage", "total ms", "avg ms", "max ms", "busy %");
+			for (std::size_t i = 0; i < m_Entries.size(); ++i)
+			{
+				const Entry& entry = m_Entries[i];
+				const std::uint64_t count = entry.count.load(std::memory_order_relaxed);
+				if (count == 0)
+				{
+					continue;
+				}
+				const double total = static_cast<double>(entry.total.load(std::memory_order_relaxed)) * 1e-6;
+				std::printf("%-12s %10.1f %10.3f %10.3f %7.1f%%\n", STAGE_NAMES[i], total, total / static_cast<double>(count),
+					static_cast<double>(entry.max.load(std::memory_order_relaxed)) * 1e-6, workerMilliseconds > 0.0 ? total * 100.0 / workerMilliseconds : 0.0);
+			}
+		}
+
+	private:
+		struct Entry
+		{
+			std::atomic<std::uint64_t> total{ 0 };
+			std::atomic<std::uint64_t> max{ 0 };
+			std::atomic<std::uint64_t> count{ 0 };
+		};
+
+		std::array<Entry, static_cast<std::size_t>(Stage::COUNT)> m_Entries;
+	};
+
+	class ScopedStage
+	{
+	public:
+		ScopedStage(StageTimings& timings, Stage stage)noexcept
+			: m_Timings(timings)
+			, m_Stage(stage)
+			, m_Start(Clock::now())
+		{}
+
+		ScopedStage(const ScopedStage&) = delete;
+		ScopedStage& operator=(const ScopedStage&) = delete;
+
+		~ScopedStage()noexcept { m_Timings.add(m_Stage, Clock::now() - m_Start); }
+
+	private:
+		StageTimings& m_Timings;
+		Stage m_Stage;
+		Clock::time_point m_Start;
+	};
+
+	// Each worker owns a deque: it pops its newest task and, when empty, steals the oldest task of
+	// another worker. Submissions are spread round-robin.
+	class WorkStealingPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+		explicit WorkStealingPool(unsigned threadsCount)
+			: m_Queues(std::max(threadsCount, 1u))
+		{
+			m_Workers.reserve(m_Queues.size());
+			for (std::size_t i = 0; i < m_Queues.size(); ++i)
+			{
+				m_Workers.emplace_back([this, i] { work(i); });
+			}
+		}
+
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+		~WorkStealingPool()
+		{
+			{
+				std::lock_guard lock{ m_Mutex };
+				m_IsStopping = true;
+			}
+			m_HasWork.notify_all();
+			for (std::thread& worker : m_Workers)
+			{
+				worker.join();
+			}
+		}
+
+		void submit(Task task)
+		{
+			Queue& queue = m_Queues[m_NextQueue++ % m_Queues.size()];
+			{
+				std::lock_guard lock{ queue.mutex };
+				queue.tasks.push_back(std::move(task));
+			}
+			{
+				std::lock_guard lock{ m_Mutex };
+				++m_Pending;
+			}
+			m_HasWork.notify_one();
+		}
+
+		[[nodiscard]] std::uint64_t getSteals()const noexcept { return m_Steals.load(std::memory_order_relaxed); }
+
+	private:
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		[[nodiscard]] bool take(std::size_t index, Task& task)
+		{
+			{
+				Queue& own = m_Queues[index];
+				std::lock_guard lock{ own.mutex };
+				if (!own.tasks.empty())
+				{
+					task = std::move(own.tasks.back());
+					own.tasks.pop_back();
+					return true;
+				}
+			}
+			for (std::size_t i = 1; i < m_Queues.size(); ++i)
+			{
+				Queue& victim = m_Queues[(index + i) % m_Queues.size()];
+				std::lock_guard lock{ victim.mutex };
+				if (!victim.tasks.empty())
+				{
+					task = std::move(victim.tasks.front());
+					victim.tasks.pop_front();
+					m_Steals.fetch_add(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void work(std::size_t index)
+		{
+			for (;;)
+			{
+				{
+					std::unique_lock lock{ m_Mutex };
+					m_HasWork.wait(lock, [this] { return m_IsStopping || m_Pending > 0; });
+					if (m_Pending == 0)
+					{
+						return;
+					}
+					--m_Pending;
+				}
+				Task task;
+				while (!take(index, task))
+				{
+					// Every claimed count matches a queued task; another worker may just hold its queue.
+					std::this_thread::yield();
+				}
+				task();
+			}
+		}
+
+		std::vector<Queue> m_Queues;
+		std::vector<std::thread> m_Workers;
+		std::mutex m_Mutex;
+		std::condition_variable m_HasWork;
+		std::size_t m_Pending = 0;
+		std::size_t m_NextQueue = 0;
+		bool m_IsStopping = false;
+		std::atomic<std::uint64_t> m_Steals{ 0 };
+	};
+
+	// Limits how many images are loaded at once.
+	class InFlightLimit
+	{
+	public:
+		explicit InFlightLimit(std::size_t limit)noexcept
+			: m_Limit(std::max<std::size_t>(limit, 1))
+		{}
+
+		void acquire()
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_Changed.wait(lock, [this] { return m_Count < m_Limit; });
+			++m_Count;
+			m_Peak = std::max(m_Peak, m_Count);
+		}
+
+		void release()
+		{
+			{
+				std::lock_guard lock{ m_Mutex };
+				--m_Count;
+			}
+			m_Changed.notify_all();
+		}
+
+		void waitIdle()
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_Changed.wait(lock, [this] { return m_Count == 0; });
+		}
+
+		[[nodiscard]] std::size_t getPeak()
+		{
+			std::lock_guard lock{ m_Mutex };
+			return m_Peak;
+		}
+
+	private:
+		std::size_t m_Limit;
+		std::size_t m_Count = 0;
+		std::size_t m_Peak = 0;
+		std::mutex m_Mutex;
+		std::condition_variable m_Changed;
+	};
+
+	[[nodiscard]] std::optional<std::uint32_t> parseFormat(std::string_view name)noexcept
+	{
+		if (name == "argb8888") { return SDL_PIXELFORMAT_ARGB8888; }
+		if (name == "abgr8888") { return SDL_PIXELFORMAT_ABGR8888; }
+		if (name == "rgba8888") { return SDL_PIXELFORMAT_RGBA8888; }
+		if (name == "rgb888") { return SDL_PIXELFORMAT_RGB888; }
+		if (name == "rgb565") { return SDL_PIXELFORMAT_RGB565; }
+		return std::nullopt;
+	}
+
+	[[nodiscard]] bool isImage(const fs::path& path)
+	{
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp" || extension == ".tga" || extension == ".gif" || extension == ".webp" || extension == ".tif" || extension == ".tiff";
+	}
+
+	// Bounding box of the pixels with non zero alpha of an ARGB8888 surface.
+	[[nodiscard]] SDL_Rect getOpaqueBounds(const sdl2::Surface& surface)noexcept
+	{
+		const int w = surface.getWidth();
+		const int h = surface.getHeight();
+		int left = w;
+		int right = -1;
+		int top = h;
+		int bottom = -1;
+		const auto* pixels = static_cast<const std::uint8_t*>(surface.getPixels());
+		for (int y = 0; y < h; ++y)
+		{
+			const auto* row = reinterpret_cast<const std::uint32_t*>(pixels + static_cast<std::ptrdiff_t>(y) * surface.getPitch());
+			int first = 0;
+			while (first < w && (row[first] >> 24) == 0)
+			{
+				++first;
+			}
+			if (first == w)
+			{
+				continue;
+			}
+			int last = w - 1;
+			while ((row[last] >> 24) == 0)
+			{
+				--last;
+			}
+			left = std::min(left, first);
+			right = std::max(right, last);
+			top = std::min(top, y);
+			bottom = y;
+		}
+		if (right < 0)
+		{
+			return SDL_Rect{ 0, 0, 1, 1 };
+		}
+		return SDL_Rect{ left, top, right - left + 1, bottom - top + 1 };
+	}
+
+	[[nodiscard]] sdl2::Surface trim(sdl2::Surface& surface)
+	{
+		const SDL_Rect bounds = getOpaqueBounds(surface);
+		if (bounds.w == surface.getWidth() && bounds.h == surface.getHeight())
+		{
+			return std::move(surface);
+		}
+		sdl2::Surface trimmed{ 0, bounds.w, bounds.h, 32, SDL_PIXELFORMAT_ARGB8888 };
+		if (!trimmed.isValid())
+		{
+			return sdl2::Surface{};
+		}
+		const auto* source = static_cast<const std::uint8_t*>(surface.getPixels()) + static_cast<std::ptrdiff_t>(bounds.y) * surface.getPitch() + bounds.x * 4;
+		auto* destination = static_cast<std::uint8_t*>(trimmed.getPixels());
+		for (int y = 0; y < bounds.h; ++y)
+		{
+			std::memcpy(destination + static_cast<std::ptrdiff_t>(y) * trimmed.getPitch(), source + static_cast<std::ptrdiff_t>(y) * surface.getPitch(), static_cast<std::size_t>(bounds.w) * 4);
+		}
+		return trimmed;
+	}
+
+	void premultiply(sdl2::Surface& surface)noexcept
+	{
+		auto* pixels = static_cast<std::uint8_t*>(surface.getPixels());
+		for (int y = 0; y < surface.getHeight(); ++y)
+		{
+			auto* row = reinterpret_cast<std::uint32_t*>(pixels + static_cast<std::ptrdiff_t>(y) * surface.getPitch());
+			for (int x = 0; x < surface.getWidth(); ++x)
+			{
+				const std::uint32_t pixel = row[x];
+				const std::uint32_t a = pixel >> 24;
+				// Rounded c * a / 255.
+				const auto mul = [a](std::uint32_t c) { const std::uint32_t t = c * a + 128; return (t + (t >> 8)) >> 8; };
+				row[x] = (a << 24) | (mul((pixel >> 16) & 0xFF) << 16) | (mul((pixel >> 8) & 0xFF) << 8) | mul(pixel & 0xFF);
+			}
+		}
+	}
+
+	[[nodiscard]] sdl2::Surface resize(sdl2::Surface& surface, int w, int h)
+	{
+		if (w == surface.getWidth() && h == surface.getHeight())
+		{
+			return std::move(surface);
+		}
+		sdl2::Surface resized{ 0, w, h, 32, SDL_PIXELFORMAT_ARGB8888 };
+		if (!resized.isValid())
+		{
+			return sdl2::Surface{};
+		}
+		const SDL_Rect source{ 0, 0, surface.getWidth(), surface.getHeight() };
+		const SDL_Rect destination{ 0, 0, w, h };
+#if SDL_VERSION_ATLEAST(2, 0, 16)
+		const bool success = sdl2::Surface::stretchLinear(surface, source, resized, destination);
+#else
+		const bool success = sdl2::Surface::stretch(surface, source, resized, destination);
+#endif
+		if (!success)
+		{
+			return sdl2::Surface{};
+		}
+		return resized;
+	}
+
+	[[nodiscard]] bool process(const Options& options, const fs::path& input, const fs::path& output, StageTimings& timings)
+	{
+		sdl2::Surface surface;
+		{
+			ScopedStage stage{ timings, Stage::LOAD };
+			surface = sdl2::Surface{ input.string() };
+		}
+		if (!surface.isValid())
+		{
+			return false;
+		}
+		{
+			// Every later stage works on ARGB8888.
+			ScopedStage stage{ timings, Stage::CONVERT };
+			if (surface.getPixelFormat()->format != SDL_PIXELFORMAT_ARGB8888)
+			{
+				surface = surface.convert(SDL_PIXELFORMAT_ARGB8888);
+			}
+		}
+		if (surface.isValid() && options.trim)
+		{
+			ScopedStage stage{ timings, Stage::TRIM };
+			surface = trim(surface);
+		}
+		if (surface.isValid() && options.premultiply)
+		{
+			ScopedStage stage{ timings, Stage::PREMULTIPLY };
+			premultiply(surface);
+		}
+		if (surface.isValid() && (options.width > 0 || options.scale != 1.0f))
+		{
+			ScopedStage stage{ timings, Stage::RESIZE };
+			const int w = options.width > 0 ? options.width : std::max(static_cast<int>(static_cast<float>(surface.getWidth()) * options.scale + 0.5f), 1);
+			const int h = options.height > 0 ? options.height : std::max(static_cast<int>(static_cast<float>(surface.getHeight()) * options.scale + 0.5f), 1);
+			surface = resize(surface, w, h);
+		}
+		if (surface.isValid() && options.format != SDL_PIXELFORMAT_ARGB8888)
+		{
+			ScopedStage stage{ timings, Stage::CONVERT };
+			surface = surface.convert(options.format);
+		}
+		if (!surface.isValid())
+		{
+			return false;
+		}
+		ScopedStage stage{ timings, Stage::SAVE };
+		std::error_code error;
+		fs::create_directories(output.parent_path(), error);
+		switch (options.encoding)
+		{
+		case Encoding::PNG: return surface.savePNG(output.string());
+		case Encoding::JPG: return surface.saveJPG(output.string(), options.quality);
+		case Encoding::BMP: return surface.saveToFile(output.string());
+		}
+		return false;
+	}
+
+	[[nodiscard]] std::optional<Options> parse(int argc, char** argv)
+	{
+		if (argc < 3)
+		{
+			return std::nullopt;
+		}
+		Options options;
+		options.input = argv[1];
+		options.output = argv[2];
+		for (int i = 3; i < argc; ++i)
+		{
+			const std::string_view arg = argv[i];
+			const bool hasValue = i + 1 < argc;
+			if (arg == "--jobs" && hasValue)
+			{
+				options.jobs = static_cast<unsigned>(std::max(std::atoi(argv[++i]), 1));
+			}
+			else if (arg == "--max-in-flight" && hasValue)
+			{
+				options.maxInFlight = static_cast<std::size_t>(std::max(std::atoi(argv[++i]), 1));
+			}
+			else if (arg == "--format" && hasValue)
+			{
+				const std::optional<std::uint32_t> format = parseFormat(argv[++i]);
+				if (!format)
+				{
+					return std::nullopt;
+				}
+				options.format = *format;
+			}
+			else if (arg == "--trim")
+			{
+				options.trim = true;
+			}
+			else if (arg == "--premultiply")
+			{
+				options.premultiply = true;
+			}
+			else if (arg == "--resize" && hasValue)
+			{
+				if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 || options.height <= 0)
+				{
+					return std::nullopt;
+				}
+			}
+			else if (arg == "--scale" && hasValue)
+			{
+				options.scale = std::strtof(argv[++i], nullptr);
+				if (options.scale <= 0.0f)
+				{
+					return std::nullopt;
+				}
+			}
+			else if (arg == "--jpg" && hasValue)
+			{
+				options.encoding = Encoding::JPG;
+				options.quality = std::clamp(std::atoi(argv[++i]), 1, 100);
+			}
+			else if (arg == "--bmp")
+			{
+				options.encoding = Encoding::BMP;
+			}
+			else if (arg == "--recursive")
+			{
+				options.recursive = true;
+			}
+			else
+			{
+				return std::nullopt;
+			}
+		}
+		if (options.maxInFlight == 0)
+		{
+			options.maxInFlight = static_cast<std::size_t>(options.jobs) * 2;
+		}
+		return options;
+	}
+
+	[[nodiscard]] const char* getExtension(Encoding encoding)noexcept
+	{
+		switch (encoding)
+		{
+		case Encoding::PNG: return ".png";
+		case Encoding::JPG: return ".jpg";
+		case Encoding::BMP: return ".bmp";
+		}
+		return "";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::optional<Options> parsed = parse(argc, argv);
+	if (!parsed)
+	{
+		std::fprintf(stderr, "usage: %s <input dir> <output dir> [--jobs N] [--max-in-flight N] [--format argb8888|abgr8888|rgba8888|rgb888|rgb565]"
+			" [--trim] [--premultiply] [--resize WxH | --scale F] [--jpg Q | --bmp] [--recursive]\n", argc > 0 ? argv[0] : "sdl2-hpp-imgproc");
+		return EXIT_FAILURE;
+	}
+	const Options& options = *parsed;
+	std::error_code error;
+	if (!fs::is_directory(options.input, error))
+	{
+		std::fprintf(stderr, "not a directory: %s\n", options.input.string().c_str());
+		return EXIT_FAILURE;
+	}
+
+	sdl2::Root root{ sdl2::WindowSystemFlag::EVENTS };
+	sdl2::image::IMGRoot imageRoot{ sdl2::image::IMGFlag::PNG | sdl2::image::IMGFlag::JPG | sdl2::image::IMGFlag::TIF | sdl2::image::IMGFlag::WEBP };
+
+	StageTimings timings;
+	std::atomic<std::uint64_t> succeeded{ 0 };
+	std::atomic<std::uint64_t> failed{ 0 };
+	InFlightLimit limit{ options.maxInFlight };
+	const Clock::time_point start = Clock::now();
+	std::uint64_t discovered = 0;
+	{
+		WorkStealingPool pool{ options.jobs };
+		const auto submit = [&](const fs::directory_entry& entry)
+		{
+			if (!entry.is_regular_file(error) || !isImage(entry.path()))
+			{
+				return;
+			}
+			fs::path output = options.output / entry.path().lexically_relative(options.input);
+			output.replace_extension(getExtension(options.encoding));
+			limit.acquire();
+			++discovered;
+			pool.submit([&, input = entry.path(), output = std::move(output)]
+			{
+				if (process(options, input, output, timings))
+				{
+					succeeded.fetch_add(1, std::memory_order_relaxed);
+				}
+				else
+				{
+					failed.fetch_add(1, std::memory_order_relaxed);
+					std::fprintf(stderr, "failed: %s (%s)\n", input.string().c_str(), SDL_GetError());
+				}
+				limit.release();
+			});
+		};
+		if (options.recursive)
+		{
+			for (const fs::directory_entry& entry : fs::recursive_directory_iterator{ options.input, fs::directory_options::skip_permission_denied, error })
+			{
+				submit(entry);
+			}
+		}
+		else
+		{
+			for (const fs::directory_entry& entry : fs::directory_iterator{ options.input, error })
+			{
+				submit(entry);
+			}
+		}
+		limit.waitIdle();
+		std::printf("steals: %llu\n", static_cast<unsigned long long>(pool.getSteals()));
+	}
+	const double wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::printf("images: %llu processed, %llu failed, %llu discovered in %.2f s (%.1f images/s), peak in flight %zu\n",
+		static_cast<unsigned long long>(succeeded.load()), static_cast<unsigned long long>(failed.load()), static_cast<unsigned long long>(discovered),
+		wallSeconds, wallSeconds > 0.0 ? static_cast<double>(succeeded.load()) / wallSeconds : 0.0, limit.getPeak());
+	timings.print(wallSeconds, options.jobs);
+	return failed.load() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}